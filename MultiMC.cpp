@@ -28,6 +28,9 @@
 #include "logic/InstanceLauncher.h"
 #include "logic/net/HttpMetaCache.h"
 #include "logic/net/URLConstants.h"
+#include "logic/net/NetScheduler.h"
+#include "logic/JarBuildCache.h"
+#include "logic/java/JavaProbeCache.h"
 
 #include "logic/java/JavaUtils.h"
 
@@ -231,7 +234,7 @@ MultiMC::MultiMC(int &argc, char **argv, bool test_mode) : QApplication(argc, ar
 	}
 	m_instances.reset(new InstanceList(InstDirSetting->get().toString(), this));
 	QLOG_INFO() << "Loading Instances...";
-	m_instances->loadList();
+	m_instances->loadCachedList();
 	connect(InstDirSetting.get(), SIGNAL(SettingChanged(const Setting &, QVariant)),
 			m_instances.get(), SLOT(on_InstFolderChanged(const Setting &, QVariant)));
 
@@ -244,9 +247,18 @@ MultiMC::MultiMC(int &argc, char **argv, bool test_mode) : QApplication(argc, ar
 	// init the http meta cache
 	initHttpMetaCache();
 
+	// and the jars built from it, shared by the instances
+	m_jarbuildcache.reset(new JarBuildCache("jarbuilds"));
+
+	// what the java binaries on this system are, so they don't have to be started to find out
+	m_javaprobecache.reset(new JavaProbeCache("javaprobes.dat"));
+
 	// create the global network manager
 	m_qnam.reset(new QNetworkAccessManager(this));
 
+	// and the scheduler that decides when downloads get to use it
+	m_netscheduler.reset(new NetScheduler());
+
 	m_translationChecker->downloadTranslations();
 
 	// init proxy settings
@@ -510,6 +522,8 @@ void MultiMC::initGlobalSettings(bool test_mode)
 	m_settings->registerSetting("RaiseConsole", true);
 	m_settings->registerSetting("AutoCloseConsole", true);
 	m_settings->registerSetting("LogPrePostOutput", true);
+	// lines kept in memory, the rest is only in the instance's console.log
+	m_settings->registerSetting("ConsoleMaxLines", 100000);
 
 	// Console Colors
 	//	m_settings->registerSetting("SysMessageColor", QColor(Qt::blue));
@@ -769,10 +783,17 @@ void MultiMC::installUpdates(const QString updateFilesDir, UpdateFlags flags)
 
 void MultiMC::onExit()
 {
+	// settings changed just before quitting may not be on disk yet
+	m_settings->flush();
+	for (int i = 0; i < m_instances->count(); i++)
+	{
+		m_instances->at(i)->settings().flush();
+	}
 	if (m_updateOnExitPath.size())
 	{
 		installUpdates(m_updateOnExitPath, m_updateOnExitFlags);
 	}
+	QsLogging::Logger::instance().flush();
 }
 
 bool MultiMC::openJsonEditor(const QString &filename)
@@ -9,11 +9,14 @@
 class MinecraftVersionList;
 class LWJGLVersionList;
 class HttpMetaCache;
+class JarBuildCache;
+class JavaProbeCache;
 class SettingsObject;
 class InstanceList;
 class MojangAccountList;
 class IconList;
 class QNetworkAccessManager;
+class NetScheduler;
 class ForgeVersionList;
 class LiteLoaderVersionList;
 class JavaVersionList;
@@ -83,11 +86,26 @@ public:
 		return m_qnam;
 	}
 
+	std::shared_ptr<NetScheduler> netScheduler()
+	{
+		return m_netscheduler;
+	}
+
 	std::shared_ptr<HttpMetaCache> metacache()
 	{
 		return m_metacache;
 	}
 
+	std::shared_ptr<JarBuildCache> jarBuildCache()
+	{
+		return m_jarbuildcache;
+	}
+
+	std::shared_ptr<JavaProbeCache> javaProbeCache()
+	{
+		return m_javaprobecache;
+	}
+
 	std::shared_ptr<UpdateChecker> updateChecker()
 	{
 		return m_updateChecker;
@@ -200,7 +218,10 @@ private:
 	std::shared_ptr<MojangAccountList> m_accounts;
 	std::shared_ptr<IconList> m_icons;
 	std::shared_ptr<QNetworkAccessManager> m_qnam;
+	std::shared_ptr<NetScheduler> m_netscheduler;
 	std::shared_ptr<HttpMetaCache> m_metacache;
+	std::shared_ptr<JarBuildCache> m_jarbuildcache;
+	std::shared_ptr<JavaProbeCache> m_javaprobecache;
 	std::shared_ptr<LWJGLVersionList> m_lwjgllist;
 	std::shared_ptr<ForgeVersionList> m_forgelist;
 	std::shared_ptr<LiteLoaderVersionList> m_liteloaderlist;
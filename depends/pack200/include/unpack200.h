@@ -25,6 +25,22 @@
 
 #pragma once
 #include <string>
+#include <functional>
+#include <cstdio>
+#include <cstdint>
+
+/**
+ * Reader callback for streaming PACK200 input.
+ * Fills up to maxlen bytes of buf and returns the number of bytes read. 0 or less means EOF.
+ * May block until data is available.
+ */
+typedef std::function<int64_t(void *buf, int64_t maxlen)> unpack_200_reader;
+
+/**
+ * Writer callback for streaming the unpacked jar.
+ * Has to take all len bytes of buf. Throw std::runtime_error to abort the unpacking.
+ */
+typedef std::function<void(const void *buf, int64_t len)> unpack_200_writer;
 
 /**
  * @brief Unpack a PACK200 file
@@ -35,3 +51,13 @@
  * @throw std::runtime_error for any error encountered
  */
 void unpack_200(FILE * input, FILE * output);
+
+/**
+ * @brief Unpack a PACK200 stream, pulling the input from a reader callback
+ *
+ * @param input Reader supplying the PACK200 data.
+ * @param output Writer receiving the jar data, in order.
+ * @return void
+ * @throw std::runtime_error for any error encountered
+ */
+void unpack_200(unpack_200_reader input, unpack_200_writer output);
@@ -3509,6 +3509,7 @@ void unpacker::reset()
 
 	// restore selected interface state:
 	infileptr = save_u.infileptr;
+	inreader = save_u.inreader;
 	inbytes = save_u.inbytes;
 	jarout = save_u.jarout;
 	gzin = save_u.gzin;
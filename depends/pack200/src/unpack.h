@@ -159,6 +159,7 @@ struct unpacker
 
 	// if running Unix-style, here are the inputs and outputs
 	FILE *infileptr; // buffered
+	void *inreader;  // unpack_200_reader, if reading through a callback
 	bytes inbytes;   // direct
 	gunzip *gzin;	// gunzip filter, if any
 	jar *jarout;	 // output JAR file
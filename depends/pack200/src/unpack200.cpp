@@ -71,6 +71,26 @@ static int64_t read_input_via_stdio(unpacker *u, void *buf, int64_t minlen, int6
 	return numread;
 }
 
+// Callback for fetching data through a user supplied reader.
+static int64_t read_input_via_reader(unpacker *u, void *buf, int64_t minlen, int64_t maxlen)
+{
+	assert(u->inreader != nullptr);
+	assert(minlen <= maxlen); // don't talk nonsense
+	auto &reader = *(unpack_200_reader *)u->inreader;
+	int64_t numread = 0;
+	char *bufptr = (char *)buf;
+	while (numread < minlen)
+	{
+		int64_t nr = reader(bufptr, maxlen - numread);
+		if (nr <= 0)
+			break;
+		numread += nr;
+		bufptr += nr;
+		assert(numread <= maxlen);
+	}
+	return numread;
+}
+
 enum
 {
 	EOF_MAGIC = 0,
@@ -94,19 +114,14 @@ static int read_magic(unpacker *u, char peek[], int peeklen)
 	return magic;
 }
 
-void unpack_200(FILE *input, FILE *output)
+static void unpack_200_run(unpacker &u, FILE *output, unpack_200_writer *writer = nullptr)
 {
-	unpacker u;
-	u.init(read_input_via_stdio);
-
 	// initialize jar output
 	// the output takes ownership of the file handle
 	jar jarout;
 	jarout.init(&u);
 	jarout.jarfp = output;
-
-	// the input doesn't
-	u.infileptr = input;
+	jarout.jarwriter = writer;
 
 	// read the magic!
 	char peek[4];
@@ -158,5 +173,23 @@ void unpack_200(FILE *input, FILE *output)
 	}
 	u.finish();
 	u.free(); // tidy up malloc blocks
+}
+
+void unpack_200(FILE *input, FILE *output)
+{
+	unpacker u;
+	u.init(read_input_via_stdio);
+
+	// the input doesn't get owned by the unpacker
+	u.infileptr = input;
+	unpack_200_run(u, output);
 	fclose(input);
 }
+
+void unpack_200(unpack_200_reader input, unpack_200_writer output)
+{
+	unpacker u;
+	u.init(read_input_via_reader);
+	u.inreader = &input;
+	unpack_200_run(u, nullptr, &output);
+}
@@ -47,6 +47,7 @@
 #include "unpack.h"
 
 #include "zip.h"
+#include "unpack200.h"
 
 #include "zlib.h"
 
@@ -76,6 +77,13 @@ void jar::init(unpacker *u_)
 // Write data to the ZIP output stream.
 void jar::write_data(void *buff, int len)
 {
+	if (jarwriter != nullptr)
+	{
+		auto &writer = *(unpack_200_writer *)jarwriter;
+		writer(buff, len);
+		output_file_offset += len;
+		return;
+	}
 	while (len > 0)
 	{
 		int rc = (int)fwrite(buff, 1, len, jarfp);
@@ -303,7 +311,12 @@ void jar::addDirectoryToJarFile(const char *dir_name)
 // Write out the central directory and close the jar file.
 void jar::closeJarFile(bool central)
 {
-	if (jarfp)
+	if (jarwriter)
+	{
+		if (central)
+			write_central_directory();
+	}
+	else if (jarfp)
 	{
 		fflush(jarfp);
 		if (central)
@@ -33,6 +33,8 @@ struct jar
 {
 	// JAR file writer
 	FILE *jarfp;
+	// user supplied writer (unpack_200_writer), used instead of jarfp when set
+	void *jarwriter;
 	int default_modtime;
 
 	// Used by unix2dostime:
@@ -1,5 +1,80 @@
 #include "JlCompress.h"
 #include <QDebug>
+#include <QQueue>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+#include <string.h>
+
+namespace {
+
+/// Files bigger than this are deflated in pieces, on several threads.
+const qint64 deflateChunkSize = 1024 * 1024;
+/// Data before a chunk that primes the dictionary, so splitting costs little ratio.
+const qint64 deflateDictionarySize = 32 * 1024;
+
+/// A piece of a file to compress.
+struct DeflateChunk
+{
+    QString fileName;
+    qint64 offset;
+    qint64 length;
+    bool last;
+};
+
+/// A compressed piece of a file, a part of its raw deflate stream.
+struct DeflatedChunk
+{
+    QByteArray data;
+    uLong crc;
+    qint64 length;
+    bool ok;
+};
+
+/**
+ * Compresses one chunk on its own. Every chunk but the last of a file ends with a sync
+ * flush, so it stops on a byte boundary and the chunks of a file concatenate into a
+ * single valid deflate stream, like pigz does it.
+ */
+DeflatedChunk deflateChunk(const DeflateChunk &chunk)
+{
+    DeflatedChunk result;
+    result.crc = crc32(0L, Z_NULL, 0);
+    result.length = chunk.length;
+    result.ok = false;
+
+    QFile file(chunk.fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return result;
+    qint64 dictionaryLength = qMin(chunk.offset, deflateDictionarySize);
+    if (!file.seek(chunk.offset - dictionaryLength))
+        return result;
+    QByteArray input = file.read(dictionaryLength + chunk.length);
+    if (input.size() != dictionaryLength + chunk.length)
+        return result;
+    const Bytef *data = (const Bytef *)input.constData() + dictionaryLength;
+    result.crc = crc32(result.crc, data, (uInt)chunk.length);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, DEF_MEM_LEVEL,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+        return result;
+    if (dictionaryLength > 0)
+        deflateSetDictionary(&stream, (const Bytef *)input.constData(), (uInt)dictionaryLength);
+    // deflateBound() covers Z_FINISH, the sync flush marker needs a few bytes more
+    result.data.resize(deflateBound(&stream, (uLong)chunk.length) + 16);
+    stream.next_in = (Bytef *)data;
+    stream.avail_in = (uInt)chunk.length;
+    stream.next_out = (Bytef *)result.data.data();
+    stream.avail_out = (uInt)result.data.size();
+    int err = deflate(&stream, chunk.last ? Z_FINISH : Z_SYNC_FLUSH);
+    result.ok = chunk.last ? err == Z_STREAM_END : err == Z_OK && stream.avail_in == 0;
+    result.data.resize(result.data.size() - stream.avail_out);
+    deflateEnd(&stream);
+    return result;
+}
+
+}
 
 bool JlCompress::copyData(QIODevice &inFile, QIODevice &outFile)
 {
@@ -14,6 +89,42 @@ bool JlCompress::copyData(QIODevice &inFile, QIODevice &outFile)
     return true;
 }
 
+bool JlCompress::copyRawFile(QuaZip* from, QuaZip* into)
+{
+    if (!from || !into) return false;
+    QuaZipFileInfo info;
+    if (!from->getCurrentFileInfo(&info)) return false;
+
+    int method = 0;
+    int level = 0;
+    QuaZipFile inFile(from);
+    if (!inFile.open(QIODevice::ReadOnly, &method, &level, true)) return false;
+
+    QuaZipNewInfo newInfo(info.name);
+    newInfo.dateTime = info.dateTime;
+    newInfo.uncompressedSize = info.uncompressedSize;
+    QuaZipFile outFile(into);
+    if (!outFile.open(QIODevice::WriteOnly, newInfo, NULL, info.crc, method, level, true)) {
+        inFile.close();
+        return false;
+    }
+
+    // atEnd() goes by the uncompressed size, even in raw mode
+    qint64 remaining = info.compressedSize;
+    bool ok = true;
+    while (ok && remaining > 0) {
+        char buf[16384];
+        qint64 readLen = inFile.read(buf, qMin<qint64>(remaining, sizeof(buf)));
+        ok = readLen > 0 && outFile.write(buf, readLen) == readLen;
+        remaining -= readLen;
+    }
+
+    outFile.close();
+    ok = ok && outFile.getZipError() == ZIP_OK;
+    inFile.close();
+    return ok && inFile.getZipError() == UNZ_OK;
+}
+
 /**OK
  * Comprime il file fileName, nell'oggetto zip, con il nome fileDest.
  *
@@ -29,32 +140,71 @@ bool JlCompress::compressFile(QuaZip* zip, QString fileName, QString fileDest) {
     // zip: oggetto dove aggiungere il file
     // fileName: nome del file reale
     // fileDest: nome del file all'interno del file compresso
+    return compressFiles(zip, QStringList() << fileName, QStringList() << fileDest);
+}
 
-    // Controllo l'apertura dello zip
-    if (!zip) return false;
+bool JlCompress::compressFiles(QuaZip* zip, QStringList fileNames, QStringList fileDests) {
+    if (!zip || fileNames.size() != fileDests.size()) return false;
     if (zip->getMode()!=QuaZip::mdCreate &&
         zip->getMode()!=QuaZip::mdAppend &&
         zip->getMode()!=QuaZip::mdAdd) return false;
 
-    // Apro il file originale
-    QFile inFile;
-    inFile.setFileName(fileName);
-    if(!inFile.open(QIODevice::ReadOnly)) return false;
-
-    // Apro il file risulato
-    QuaZipFile outFile(zip);
-    if(!outFile.open(QIODevice::WriteOnly, QuaZipNewInfo(fileDest, inFile.fileName()))) return false;
-
-    // Copio i dati
-    if (!copyData(inFile, outFile) || outFile.getZipError()!=UNZ_OK) {
-        return false;
+    // split every file into chunks, a chunk never spans two files
+    QList<DeflateChunk> chunks;
+    QList<int> chunkCounts;
+    QList<qint64> sizes;
+    for (int i = 0; i < fileNames.size(); i++) {
+        QFileInfo info(fileNames[i]);
+        if (!info.isFile()) return false;
+        qint64 size = info.size();
+        qint64 offset = 0;
+        int count = 0;
+        do {
+            DeflateChunk chunk;
+            chunk.fileName = fileNames[i];
+            chunk.offset = offset;
+            chunk.length = qMin(deflateChunkSize, size - offset);
+            chunk.last = offset + chunk.length == size;
+            chunks.append(chunk);
+            offset += chunk.length;
+            count++;
+        } while (offset < size);
+        chunkCounts.append(count);
+        sizes.append(size);
     }
 
-    // Chiudo i file
-    outFile.close();
-    if (outFile.getZipError()!=UNZ_OK) return false;
-    inFile.close();
-
+    // deflate on the thread pool, a few chunks ahead of the one being written, so memory
+    // use stays bounded no matter how big the files are
+    const int maxInFlight = qMax(2, QThread::idealThreadCount() * 2);
+    QQueue<QFuture<DeflatedChunk> > inFlight;
+    int nextChunk = 0;
+    for (int i = 0; i < fileNames.size(); i++) {
+        // same entry as QuaZipFile would write when compressing, level flags included;
+        // the CRC is set once all chunks are written
+        QuaZipNewInfo newInfo(fileDests[i], fileNames[i]);
+        newInfo.uncompressedSize = sizes[i];
+        QuaZipFile outFile(zip);
+        if (!outFile.open(QIODevice::WriteOnly, newInfo, NULL, 0, Z_DEFLATED,
+                          Z_DEFAULT_COMPRESSION, true))
+            return false;
+        uLong crc = crc32(0L, Z_NULL, 0);
+        bool ok = true;
+        for (int c = 0; ok && c < chunkCounts[i]; c++) {
+            while (inFlight.size() < maxInFlight && nextChunk < chunks.size())
+                inFlight.enqueue(QtConcurrent::run(deflateChunk, chunks[nextChunk++]));
+            DeflatedChunk chunk = inFlight.dequeue().result();
+            ok = chunk.ok && outFile.write(chunk.data) == chunk.data.size();
+            crc = crc32_combine(crc, chunk.crc, chunk.length);
+        }
+        outFile.setRawCrc(crc);
+        outFile.close();
+        if (!ok || outFile.getZipError() != ZIP_OK) {
+            // the chunks still queued only touch their own copies, let them finish
+            Q_FOREACH (QFuture<DeflatedChunk> future, inFlight)
+                future.waitForFinished();
+            return false;
+        }
+    }
     return true;
 }
 
@@ -76,6 +226,18 @@ bool JlCompress::compressFile(QuaZip* zip, QString fileName, QString fileDest) {
  * funzione.
  */
 bool JlCompress::compressSubDir( QuaZip* parentZip, QString dir, QString parentDir, bool recursive, QSet<QString>& added )
+{
+    QStringList fileNames, fileDests;
+    if (!collectSubDir(parentZip, dir, parentDir, recursive, fileNames, fileDests))
+        return false;
+    if (!compressFiles(parentZip, fileNames, fileDests))
+        return false;
+    Q_FOREACH (QString fileDest, fileDests)
+        added.insert(fileDest);
+    return true;
+}
+
+bool JlCompress::collectSubDir( QuaZip* parentZip, QString dir, QString parentDir, bool recursive, QStringList& fileNames, QStringList& fileDests )
 {
     // zip: oggetto dove aggiungere il file
     // dir: cartella reale corrente
@@ -99,7 +261,7 @@ bool JlCompress::compressSubDir( QuaZip* parentZip, QString dir, QString parentD
         Q_FOREACH (QFileInfo file, files)
 		{
             // Comprimo la sotto cartella
-            if(!compressSubDir( parentZip,file.absoluteFilePath(),parentDir,recursive,added)) return false;
+            if(!collectSubDir( parentZip,file.absoluteFilePath(),parentDir,recursive,fileNames,fileDests)) return false;
         }
     }
 
@@ -115,9 +277,8 @@ bool JlCompress::compressSubDir( QuaZip* parentZip, QString dir, QString parentD
         QString filename = origDirectory.relativeFilePath(file.absoluteFilePath());
 
         // Comprimo il file
-        if (!compressFile( parentZip,file.absoluteFilePath(),filename))
-			return false;
-		added.insert(filename);
+        fileNames.append(file.absoluteFilePath());
+        fileDests.append(filename);
     }
 
     return true;
@@ -258,12 +419,18 @@ bool JlCompress::compressFiles(QString fileCompressed, QStringList files) {
 
     // Comprimo i file
     QFileInfo info;
+    QStringList fileDests;
     Q_FOREACH (QString file, files) {
         info.setFile(file);
-        if (!info.exists() || !compressFile(&zip,file,info.fileName())) {
+        if (!info.exists()) {
             QFile::remove(fileCompressed);
             return false;
         }
+        fileDests.append(info.fileName());
+    }
+    if (!compressFiles(&zip,files,fileDests)) {
+        QFile::remove(fileCompressed);
+        return false;
     }
 
     // Chiudo il file zip
@@ -22,6 +22,8 @@ private:
       \return true if success, false otherwise.
       */
     static bool removeFile(QStringList listFile);
+    /// Find the files compressSubDir() packs, in the order it packs them.
+    static bool collectSubDir( QuaZip* parentZip, QString dir, QString parentDir, bool recursive, QStringList& fileNames, QStringList& fileDests );
 public:
     /// Compress a single file.
     /**
@@ -31,6 +33,23 @@ public:
       \return true if success, false otherwise.
       */
     static bool compressFile(QuaZip* zip, QString fileName, QString fileDest);
+    /// Compress several files, deflating them on the thread pool.
+    /**
+      Files bigger than a megabyte are split into pieces that are
+      deflated independently and joined into one deflate stream, so a
+      single large file uses all cores too. The entries are written in
+      the given order and look the same as the ones compressFile()
+      wrote before, including the CRC and the level flags. Pieces are
+      written as soon as they and the ones before them are done, and
+      only a couple per core are compressed ahead, so memory use does
+      not grow with the size of the files.
+      \param zip Opened zip to compress the files to.
+      \param fileNames The full paths to the source files.
+      \param fileDests The full names of the files inside the archive,
+      one for every source file.
+      \return true if success, false otherwise.
+      */
+    static bool compressFiles(QuaZip* zip, QStringList fileNames, QStringList fileDests);
     /// Compress a subdirectory.
     /**
       \param parentZip Opened zip containing the parent directory.
@@ -53,6 +72,14 @@ public:
 
     /// copy data from inFile to outFile
     static bool copyData(QIODevice &inFile, QIODevice &outFile);
+    /// Copy the current file of one archive into another, without recompressing it.
+    /**
+      The compressed data is moved byte for byte, the CRC and sizes are kept.
+      \param from Opened zip (mdUnzip), positioned on the file to copy.
+      \param into Opened zip to add the file to.
+      \return true if success, false otherwise.
+      */
+    static bool copyRawFile(QuaZip* from, QuaZip* into);
     /// Compress a single file.
     /**
       \param fileCompressed The name of the archive.
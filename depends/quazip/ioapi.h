@@ -60,6 +60,13 @@ typedef struct zlib_filefunc_def_s
 
 
 void fill_qiodevice_filefunc OF((zlib_filefunc_def* pzlib_filefunc_def));
+/* Same as fill_qiodevice_filefunc, but never maps read-only files into memory. */
+void fill_qiodevice_unmapped_filefunc OF((zlib_filefunc_def* pzlib_filefunc_def));
+/* Returns a pointer to size bytes at offset of the stream, if it was opened by
+   the qiodevice functions and is mapped into memory. NULL otherwise. The data
+   stays valid until the stream is closed. */
+const Bytef* qiodevice_mapped_data OF((const zlib_filefunc_def* pzlib_filefunc_def,
+                                       voidpf stream, uLong offset, uLong size));
 
 #define ZREAD(filefunc,filestream,buf,size) ((*((filefunc).zread_file))((filefunc).opaque,filestream,buf,size))
 #define ZWRITE(filefunc,filestream,buf,size) ((*((filefunc).zwrite_file))((filefunc).opaque,filestream,buf,size))
@@ -16,6 +16,7 @@
 #include "ioapi.h"
 #include "quazip_global.h"
 #include <QIODevice>
+#include <QFileDevice>
 
 
 /* I've found an old Unix (a SunOS 4.1.3_U1) without all SEEK_* defined.... */
@@ -32,13 +33,24 @@
 #define SEEK_SET    0
 #endif
 
-voidpf ZCALLBACK qiodevice_open_file_func (
-   voidpf opaque UNUSED,
-   voidpf file,
-   int mode)
+/* What the qiodevice functions hand to minizip as the stream. Archives that
+   are only read and live in a file are mapped into memory, so reading them is
+   a memcpy instead of a QIODevice::read(), and unzReadCurrentFile() can
+   inflate straight from the mapping (see qiodevice_mapped_data()). */
+struct QIODeviceStream
+{
+    QIODevice *iodevice;
+    /* NULL if the device isn't mapped */
+    uchar *map;
+    qint64 size;
+    qint64 pos;
+};
+
+static voidpf qiodevice_open(voidpf file, int mode, bool mapping)
 {
     QIODevice *iodevice = reinterpret_cast<QIODevice*>(file);
-    if ((mode & ZLIB_FILEFUNC_MODE_READWRITEFILTER)==ZLIB_FILEFUNC_MODE_READ)
+    bool readOnly = (mode & ZLIB_FILEFUNC_MODE_READWRITEFILTER)==ZLIB_FILEFUNC_MODE_READ;
+    if (readOnly)
         iodevice->open(QIODevice::ReadOnly);
     else
     if (mode & ZLIB_FILEFUNC_MODE_EXISTING)
@@ -52,12 +64,40 @@ voidpf ZCALLBACK qiodevice_open_file_func (
             iodevice->close();
             return NULL;
         } else {
-            return iodevice;
+            QIODeviceStream *stream = new QIODeviceStream;
+            stream->iodevice = iodevice;
+            stream->map = NULL;
+            stream->size = 0;
+            stream->pos = 0;
+            QFileDevice *filedevice = qobject_cast<QFileDevice*>(iodevice);
+            if (mapping && readOnly && filedevice != NULL) {
+                // empty files, pipes and compressed resources can't be mapped
+                stream->size = filedevice->size();
+                if (stream->size > 0)
+                    stream->map = filedevice->map(0, stream->size);
+            }
+            return stream;
         }
     } else
         return NULL;
 }
 
+voidpf ZCALLBACK qiodevice_open_file_func (
+   voidpf opaque UNUSED,
+   voidpf file,
+   int mode)
+{
+    return qiodevice_open(file, mode, true);
+}
+
+voidpf ZCALLBACK qiodevice_open_unmapped_file_func (
+   voidpf opaque UNUSED,
+   voidpf file,
+   int mode)
+{
+    return qiodevice_open(file, mode, false);
+}
+
 
 uLong ZCALLBACK qiodevice_read_file_func (
    voidpf opaque UNUSED,
@@ -65,8 +105,16 @@ uLong ZCALLBACK qiodevice_read_file_func (
    void* buf,
    uLong size)
 {
+    QIODeviceStream *s = (QIODeviceStream*)stream;
     uLong ret;
-    ret = (uLong)((QIODevice*)stream)->read((char*)buf,size);
+    if (s->map != NULL) {
+        qint64 left = s->size - s->pos;
+        ret = left < (qint64)size ? (uLong)left : size;
+        memcpy(buf, s->map + s->pos, ret);
+        s->pos += ret;
+        return ret;
+    }
+    ret = (uLong)s->iodevice->read((char*)buf,size);
     return ret;
 }
 
@@ -78,7 +126,7 @@ uLong ZCALLBACK qiodevice_write_file_func (
    uLong size)
 {
     uLong ret;
-    ret = (uLong)((QIODevice*)stream)->write((char*)buf,size);
+    ret = (uLong)((QIODeviceStream*)stream)->iodevice->write((char*)buf,size);
     return ret;
 }
 
@@ -86,8 +134,12 @@ uLong ZCALLBACK qiodevice_tell_file_func (
    voidpf opaque UNUSED,
    voidpf stream)
 {
+    QIODeviceStream *s = (QIODeviceStream*)stream;
     uLong ret;
-    ret = ((QIODevice*)stream)->pos();
+    if (s->map != NULL)
+        ret = s->pos;
+    else
+        ret = s->iodevice->pos();
     return ret;
 }
 
@@ -97,22 +149,32 @@ int ZCALLBACK qiodevice_seek_file_func (
    uLong offset,
    int origin)
 {
+    QIODeviceStream *s = (QIODeviceStream*)stream;
+    qint64 pos = s->map != NULL ? s->pos : s->iodevice->pos();
+    qint64 size = s->map != NULL ? s->size : s->iodevice->size();
     uLong qiodevice_seek_result=0;
     int ret;
     switch (origin)
     {
     case ZLIB_FILEFUNC_SEEK_CUR :
-        qiodevice_seek_result = ((QIODevice*)stream)->pos() + offset;
+        qiodevice_seek_result = pos + offset;
         break;
     case ZLIB_FILEFUNC_SEEK_END :
-        qiodevice_seek_result = ((QIODevice*)stream)->size() - offset;
+        qiodevice_seek_result = size - offset;
         break;
     case ZLIB_FILEFUNC_SEEK_SET :
         qiodevice_seek_result = offset;
         break;
     default: return -1;
     }
-    ret = !((QIODevice*)stream)->seek(qiodevice_seek_result);
+    if (s->map != NULL) {
+        // QIODevice::seek() doesn't allow going before the start either
+        if ((qint64)qiodevice_seek_result > s->size)
+            return 1;
+        s->pos = qiodevice_seek_result;
+        return 0;
+    }
+    ret = !s->iodevice->seek(qiodevice_seek_result);
     return ret;
 }
 
@@ -120,7 +182,11 @@ int ZCALLBACK qiodevice_close_file_func (
    voidpf opaque UNUSED,
    voidpf stream)
 {
-    ((QIODevice*)stream)->close();
+    QIODeviceStream *s = (QIODeviceStream*)stream;
+    if (s->map != NULL)
+        static_cast<QFileDevice*>(s->iodevice)->unmap(s->map);
+    s->iodevice->close();
+    delete s;
     return 0;
 }
 
@@ -144,3 +210,25 @@ void fill_qiodevice_filefunc (
     pzlib_filefunc_def->zerror_file = qiodevice_error_file_func;
     pzlib_filefunc_def->opaque = NULL;
 }
+
+void fill_qiodevice_unmapped_filefunc (
+  zlib_filefunc_def* pzlib_filefunc_def)
+{
+    fill_qiodevice_filefunc(pzlib_filefunc_def);
+    pzlib_filefunc_def->zopen_file = qiodevice_open_unmapped_file_func;
+}
+
+const Bytef* qiodevice_mapped_data (
+  const zlib_filefunc_def* pzlib_filefunc_def,
+  voidpf stream,
+  uLong offset,
+  uLong size)
+{
+    // the stream of a custom IO API is something else entirely
+    if (pzlib_filefunc_def->zread_file != qiodevice_read_file_func)
+        return NULL;
+    QIODeviceStream *s = (QIODeviceStream*)stream;
+    if (s->map == NULL || (qint64)offset > s->size || (qint64)size > s->size - (qint64)offset)
+        return NULL;
+    return s->map + offset;
+}
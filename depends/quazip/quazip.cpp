@@ -23,6 +23,7 @@ quazip/(un)zip.h files for details, basically it's zlib license.
 
 #include <QtCore/QFile>
 #include <QtCore/QFlags>
+#include <QtCore/QHash>
 
 #include "quazip.h"
 
@@ -63,6 +64,16 @@ class QuaZipPrivate {
     int zipError;
     /// Whether \ref QuaZip::setDataDescriptorWritingEnabled() "the data descriptor writing mode" is enabled.
     bool dataDescriptorWritingEnabled;
+    /// Whether \ref QuaZip::setFileNameIndexEnabled() "the file name index" is used.
+    bool fileNameIndexEnabled;
+    /// Whether the file name index is built for the open archive.
+    bool fileNameIndexValid;
+    /// Central directory position of every file, by name. The first of duplicates wins.
+    QHash<QString, unz_file_pos> fileNameIndex;
+    /// The same, by lower case name.
+    QHash<QString, unz_file_pos> lowerFileNameIndex;
+    /// Whether \ref QuaZip::setMemoryMappingEnabled() "memory mapping" is used.
+    bool memoryMappingEnabled;
     /// The constructor for the corresponding QuaZip constructor.
     inline QuaZipPrivate(QuaZip *q):
         q(q),
@@ -72,7 +83,10 @@ class QuaZipPrivate {
       mode(QuaZip::mdNotOpen),
       hasCurrentFile_f(false),
       zipError(UNZ_OK),
-      dataDescriptorWritingEnabled(true) {}
+      dataDescriptorWritingEnabled(true),
+      fileNameIndexEnabled(true),
+      fileNameIndexValid(false),
+      memoryMappingEnabled(false) {}
     /// The constructor for the corresponding QuaZip constructor.
     inline QuaZipPrivate(QuaZip *q, const QString &zipName):
         q(q),
@@ -83,7 +97,10 @@ class QuaZipPrivate {
       mode(QuaZip::mdNotOpen),
       hasCurrentFile_f(false),
       zipError(UNZ_OK),
-      dataDescriptorWritingEnabled(true) {}
+      dataDescriptorWritingEnabled(true),
+      fileNameIndexEnabled(true),
+      fileNameIndexValid(false),
+      memoryMappingEnabled(false) {}
     /// The constructor for the corresponding QuaZip constructor.
     inline QuaZipPrivate(QuaZip *q, QIODevice *ioDevice):
         q(q),
@@ -93,12 +110,50 @@ class QuaZipPrivate {
       mode(QuaZip::mdNotOpen),
       hasCurrentFile_f(false),
       zipError(UNZ_OK),
-      dataDescriptorWritingEnabled(true) {}
+      dataDescriptorWritingEnabled(true),
+      fileNameIndexEnabled(true),
+      fileNameIndexValid(false),
+      memoryMappingEnabled(false) {}
     /// Returns either a list of file names or a list of QuaZipFileInfo.
     template<typename TFileInfo>
         bool getFileInfoList(QList<TFileInfo> *result) const;
+    /// Reads the central directory once and fills the file name index.
+    bool buildFileNameIndex();
+    /// Forgets the file name index.
+    void clearFileNameIndex();
 };
 
+bool QuaZipPrivate::buildFileNameIndex()
+{
+  clearFileNameIndex();
+  for(bool more=q->goToFirstFile(); more; more=q->goToNextFile()) {
+    QString current=q->getCurrentFileName();
+    unz_file_pos pos;
+    if(current.isEmpty() || unzGetFilePos(unzFile_f, &pos)!=UNZ_OK) {
+      clearFileNameIndex();
+      return false;
+    }
+    if(!fileNameIndex.contains(current))
+      fileNameIndex.insert(current, pos);
+    QString lower=current.toLower();
+    if(!lowerFileNameIndex.contains(lower))
+      lowerFileNameIndex.insert(lower, pos);
+  }
+  if(zipError!=UNZ_OK) {
+    clearFileNameIndex();
+    return false;
+  }
+  fileNameIndexValid=true;
+  return true;
+}
+
+void QuaZipPrivate::clearFileNameIndex()
+{
+  fileNameIndexValid=false;
+  fileNameIndex.clear();
+  lowerFileNameIndex.clear();
+}
+
 QuaZip::QuaZip():
   p(new QuaZipPrivate(this))
 {
@@ -137,6 +192,11 @@ bool QuaZip::open(Mode mode, zlib_filefunc_def* ioApi)
       ioDevice = new QFile(p->zipName);
     }
   }
+  zlib_filefunc_def unmappedApi;
+  if (ioApi == NULL && !p->memoryMappingEnabled) {
+    fill_qiodevice_unmapped_filefunc(&unmappedApi);
+    ioApi = &unmappedApi;
+  }
   switch(mode) {
     case mdUnzip:
       p->unzFile_f=unzOpen2(ioDevice, ioApi);
@@ -199,6 +259,7 @@ void QuaZip::close()
       qWarning("QuaZip::close(): unknown mode: %d", (int)p->mode);
       return;
   }
+  p->clearFileNameIndex();
   // opened by name, need to delete the internal IO device
   if (!p->zipName.isEmpty()) {
       delete p->ioDevice;
@@ -284,6 +345,17 @@ bool QuaZip::setCurrentFile(const QString& fileName, CaseSensitivity cs)
   bool sens = convertCaseSensitivity(cs) == Qt::CaseSensitive;
   QString lower, current;
   if(!sens) lower=fileName.toLower();
+  if(p->fileNameIndexEnabled && (p->fileNameIndexValid || p->buildFileNameIndex())) {
+    const QHash<QString, unz_file_pos> &index=sens ? p->fileNameIndex : p->lowerFileNameIndex;
+    QHash<QString, unz_file_pos>::const_iterator found=index.constFind(sens ? fileName : lower);
+    p->hasCurrentFile_f=false;
+    if(found==index.constEnd())
+      return false;
+    unz_file_pos pos=found.value();
+    p->zipError=unzGoToFilePos(p->unzFile_f, &pos);
+    p->hasCurrentFile_f=p->zipError==UNZ_OK;
+    return p->hasCurrentFile_f;
+  }
   p->hasCurrentFile_f=false;
   for(bool more=goToFirstFile(); more; more=goToNextFile()) {
     current=getCurrentFileName();
@@ -385,11 +457,35 @@ QString QuaZip::getCurrentFileName()const
 void QuaZip::setFileNameCodec(QTextCodec *fileNameCodec)
 {
   p->fileNameCodec=fileNameCodec;
+  p->clearFileNameIndex();
 }
 
 void QuaZip::setFileNameCodec(const char *fileNameCodecName)
 {
   p->fileNameCodec=QTextCodec::codecForName(fileNameCodecName);
+  p->clearFileNameIndex();
+}
+
+void QuaZip::setFileNameIndexEnabled(bool enabled)
+{
+  p->fileNameIndexEnabled=enabled;
+  if(!enabled)
+    p->clearFileNameIndex();
+}
+
+bool QuaZip::isFileNameIndexEnabled() const
+{
+  return p->fileNameIndexEnabled;
+}
+
+void QuaZip::setMemoryMappingEnabled(bool enabled)
+{
+  p->memoryMappingEnabled=enabled;
+}
+
+bool QuaZip::isMemoryMappingEnabled() const
+{
+  return p->memoryMappingEnabled;
 }
 
 QTextCodec *QuaZip::getFileNameCodec()const
@@ -170,6 +170,11 @@ class QUAZIP_EXPORT QuaZip {
      *
      * In short: just forget about the \a ioApi argument and you'll be
      * fine.
+     *
+     * In mdUnzip mode, if enabled with setMemoryMappingEnabled(), the
+     * default API maps the archive into memory if the device is a
+     * QFileDevice that supports it, and falls back to
+     * QIODevice::read() otherwise.
      **/
     bool open(Mode mode, zlib_filefunc_def *ioApi =NULL);
     /// Closes ZIP file.
@@ -307,9 +312,34 @@ class QUAZIP_EXPORT QuaZip {
      *
      * Should be used only in QuaZip::mdUnzip mode.
      *
-     * \sa setFileNameCodec(), CaseSensitivity
+     * Unless the file name index is disabled, the first call after
+     * open() reads the whole central directory once and indexes it by
+     * name. This and all the following calls are then hash lookups.
+     *
+     * \sa setFileNameCodec(), CaseSensitivity, setFileNameIndexEnabled()
      **/
     bool setCurrentFile(const QString& fileName, CaseSensitivity cs =csDefault);
+    /// Enables or disables the file name index of setCurrentFile().
+    /** The index is enabled by default. Disabling it makes
+     * setCurrentFile() scan the central directory on every call, like
+     * unzLocateFile() does. That may be faster for a single lookup of
+     * a file that is near the start of a big archive.
+     **/
+    void setFileNameIndexEnabled(bool enabled);
+    /// Returns \c true if setCurrentFile() uses the file name index.
+    bool isFileNameIndexEnabled() const;
+    /// Enables or disables memory mapping of archives opened for reading.
+    /** Mapping is disabled by default and takes effect on the next open()
+     * with the default IO API. A mapped archive is read with memcpy()
+     * instead of QIODevice::read(), and the compressed data of its files
+     * is inflated straight from the mapping. Only enable it for archives
+     * nobody else writes to while they are open: truncating a mapped
+     * archive crashes the reader instead of failing the read, and on
+     * Windows the mapping keeps the file from being replaced or deleted.
+     **/
+    void setMemoryMappingEnabled(bool enabled);
+    /// Returns \c true if archives are mapped into memory for reading.
+    bool isMemoryMappingEnabled() const;
     /// Returns \c true if the current file has been set.
     bool hasCurrentFile() const;
     /// Retrieves information about the current file.
@@ -415,6 +415,12 @@ bool QuaZipFile::getFileInfo(QuaZipFileInfo *info)
   return p->zipError==UNZ_OK;
 }
 
+void QuaZipFile::setRawCrc(quint32 crc)
+{
+  if(isRaw() && (openMode()&WriteOnly))
+    p->crc=crc;
+}
+
 void QuaZipFile::close()
 {
   p->resetZipError();
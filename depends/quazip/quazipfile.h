@@ -429,6 +429,14 @@ class QUAZIP_EXPORT QuaZipFile: public QIODevice {
      * Returns \c false in the case of an error.
      **/
     bool getFileInfo(QuaZipFileInfo *info);
+    /// Sets the CRC a raw file is closed with.
+    /** Replaces the \a crc passed to open(), for files written in raw mode
+     * whose CRC is only known once all of the data has been written.
+     *
+     * File must be open for writing in raw mode before calling this
+     * function, it does nothing otherwise.
+     **/
+    void setRawCrc(quint32 crc);
     /// Closes the file.
     /** Call getZipError() to determine if the close was successful.
      **/
@@ -72,6 +72,11 @@ woven in by Terry Thorsen 1/2003.
 #define UNZ_BUFSIZE (16384)
 #endif
 
+/* the most of a memory-mapped file that is handed to inflate at once */
+#ifndef UNZ_MAXMAPPED
+#define UNZ_MAXMAPPED (0x40000000)
+#endif
+
 #ifndef UNZ_MAXFILENAMEINZIP
 #define UNZ_MAXFILENAMEINZIP (256)
 #endif
@@ -1272,41 +1277,65 @@ extern int ZEXPORT unzReadCurrentFile  (file, buf, len)
             (pfile_in_zip_read_info->rest_read_compressed>0))
         {
             uInt uReadThis = UNZ_BUFSIZE;
+            const Bytef* mapped = NULL;
             if (pfile_in_zip_read_info->rest_read_compressed<uReadThis)
                 uReadThis = (uInt)pfile_in_zip_read_info->rest_read_compressed;
             if (uReadThis == 0)
                 return UNZ_EOF;
-            if (ZSEEK(pfile_in_zip_read_info->z_filefunc,
-                      pfile_in_zip_read_info->filestream,
-                      pfile_in_zip_read_info->pos_in_zipfile +
-                         pfile_in_zip_read_info->byte_before_the_zipfile,
-                         ZLIB_FILEFUNC_SEEK_SET)!=0)
-                return UNZ_ERRNO;
-            if (ZREAD(pfile_in_zip_read_info->z_filefunc,
-                      pfile_in_zip_read_info->filestream,
-                      pfile_in_zip_read_info->read_buffer,
-                      uReadThis)!=uReadThis)
-                return UNZ_ERRNO;
-
 
+            /* a memory-mapped archive is handed to inflate as it is, all of
+               the rest of the file at once. Encrypted data has to be decoded
+               into the buffer. */
 #            ifndef NOUNCRYPT
-            if(s->encrypted)
+            if(!s->encrypted)
+#            endif
             {
-                uInt i;
-                for(i=0;i<uReadThis;i++)
-                  pfile_in_zip_read_info->read_buffer[i] =
-                      zdecode(s->keys,s->pcrc_32_tab,
-                              pfile_in_zip_read_info->read_buffer[i]);
+                uLong uMapThis = pfile_in_zip_read_info->rest_read_compressed;
+                if (uMapThis > UNZ_MAXMAPPED)
+                    uMapThis = UNZ_MAXMAPPED;
+                mapped = qiodevice_mapped_data(&pfile_in_zip_read_info->z_filefunc,
+                                               pfile_in_zip_read_info->filestream,
+                                               pfile_in_zip_read_info->pos_in_zipfile +
+                                                  pfile_in_zip_read_info->byte_before_the_zipfile,
+                                               uMapThis);
+                if (mapped != NULL)
+                    uReadThis = (uInt)uMapThis;
+            }
+
+            if (mapped == NULL)
+            {
+                if (ZSEEK(pfile_in_zip_read_info->z_filefunc,
+                          pfile_in_zip_read_info->filestream,
+                          pfile_in_zip_read_info->pos_in_zipfile +
+                             pfile_in_zip_read_info->byte_before_the_zipfile,
+                             ZLIB_FILEFUNC_SEEK_SET)!=0)
+                    return UNZ_ERRNO;
+                if (ZREAD(pfile_in_zip_read_info->z_filefunc,
+                          pfile_in_zip_read_info->filestream,
+                          pfile_in_zip_read_info->read_buffer,
+                          uReadThis)!=uReadThis)
+                    return UNZ_ERRNO;
+
+
+#                ifndef NOUNCRYPT
+                if(s->encrypted)
+                {
+                    uInt i;
+                    for(i=0;i<uReadThis;i++)
+                      pfile_in_zip_read_info->read_buffer[i] =
+                          zdecode(s->keys,s->pcrc_32_tab,
+                                  pfile_in_zip_read_info->read_buffer[i]);
+                }
+#                endif
             }
-#            endif
 
 
             pfile_in_zip_read_info->pos_in_zipfile += uReadThis;
 
             pfile_in_zip_read_info->rest_read_compressed-=uReadThis;
 
-            pfile_in_zip_read_info->stream.next_in =
-                (Bytef*)pfile_in_zip_read_info->read_buffer;
+            pfile_in_zip_read_info->stream.next_in = mapped != NULL ?
+                (Bytef*)mapped : (Bytef*)pfile_in_zip_read_info->read_buffer;
             pfile_in_zip_read_info->stream.avail_in = (uInt)uReadThis;
         }
 
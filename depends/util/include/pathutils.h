@@ -53,6 +53,32 @@ LIBUTIL_EXPORT bool ensureFolderPathExists(QString filenamepath);
 
 LIBUTIL_EXPORT bool copyPath(QString src, QString dst);
 
+enum FileLinkType
+{
+	FileLink_Failed,
+	FileLink_Hard,
+	FileLink_Reflink,
+	FileLink_Symbolic,
+	FileLink_Copy
+};
+
+/**
+ * Makes dst a file with the contents of src, without duplicating the data if possible.
+ * Tries a hard link, then a reflink (copy-on-write clone), then a symbolic link and copies
+ * the file as a last resort. dst must not exist.
+ *
+ * Pass allowSymlink = false if src may be removed while dst is still in use.
+ *
+ * Returns the kind of file that was created, FileLink_Failed if nothing worked
+ */
+LIBUTIL_EXPORT FileLinkType linkOrCopyFile(QString src, QString dst, bool allowSymlink = true);
+
+/**
+ * Moves src over dst in one step, so dst is always either the old or the new file.
+ * Both have to be on the same file system.
+ */
+LIBUTIL_EXPORT bool replaceFile(QString src, QString dst);
+
 /// Opens the given file in the default application.
 LIBUTIL_EXPORT void openFileInDefaultProgram(QString filename);
 
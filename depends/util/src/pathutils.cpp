@@ -14,12 +14,27 @@
  */
 
 #include "include/pathutils.h"
+#include "include/osutils.h"
 
 #include <QFileInfo>
+#include <QFile>
 #include <QDir>
 #include <QDesktopServices>
 #include <QUrl>
 
+#if WINDOWS
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <stdio.h>
+#endif
+
+#if LINUX
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
 QString PathCombine(QString path1, QString path2)
 {
     return QDir::cleanPath(path1 + QDir::separator() + path2);
@@ -129,6 +144,66 @@ bool copyPath(QString src, QString dst)
 	return true;
 }
 
+static bool hardLinkFile(const QString &src, const QString &dst)
+{
+#if WINDOWS
+	return CreateHardLinkW((LPCWSTR)QDir::toNativeSeparators(dst).utf16(),
+						   (LPCWSTR)QDir::toNativeSeparators(src).utf16(), NULL);
+#else
+	return ::link(QFile::encodeName(src).constData(), QFile::encodeName(dst).constData()) == 0;
+#endif
+}
+
+static bool reflinkFile(const QString &src, const QString &dst)
+{
+#if LINUX && defined(FICLONE)
+	int in = ::open(QFile::encodeName(src).constData(), O_RDONLY);
+	if (in == -1)
+		return false;
+	int out = ::open(QFile::encodeName(dst).constData(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+	if (out == -1)
+	{
+		::close(in);
+		return false;
+	}
+	bool cloned = ::ioctl(out, FICLONE, in) == 0;
+	::close(in);
+	::close(out);
+	if (!cloned)
+		QFile::remove(dst);
+	return cloned;
+#else
+	return false;
+#endif
+}
+
+FileLinkType linkOrCopyFile(QString src, QString dst, bool allowSymlink)
+{
+	if (hardLinkFile(src, dst))
+		return FileLink_Hard;
+	if (reflinkFile(src, dst))
+		return FileLink_Reflink;
+#if !WINDOWS
+	// symlinks on windows need special privileges and QFile::link makes shortcuts there
+	if (allowSymlink && QFile::link(QFileInfo(src).absoluteFilePath(), dst))
+		return FileLink_Symbolic;
+#endif
+	if (QFile::copy(src, dst))
+		return FileLink_Copy;
+	return FileLink_Failed;
+}
+
+bool replaceFile(QString src, QString dst)
+{
+#if WINDOWS
+	return MoveFileExW((LPCWSTR)QDir::toNativeSeparators(src).utf16(),
+					   (LPCWSTR)QDir::toNativeSeparators(dst).utf16(),
+					   MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+	return ::rename(QFile::encodeName(src).constData(), QFile::encodeName(dst).constData()) == 0;
+#endif
+}
+
 void openDirInDefaultProgram(QString path, bool ensureExists)
 {
 	QDir parentPath;
@@ -1289,6 +1289,10 @@ void MainWindow::launchInstance(InstancePtr instance, AuthSessionPtr session,
 
 	QString launchScript;
 
+	// anything reading the configs from now on should see the latest changes
+	MMC->settings()->flush();
+	instance->settings().flush();
+
 	if (!instance->prepareForLaunch(session, launchScript))
 		return;
 
@@ -10,6 +10,8 @@
 #include <QMimeData>
 #include <QCache>
 #include <QScrollBar>
+#include <QSet>
+#include <algorithm>
 
 #include "VisualGroup.h"
 #include "logger/QsLog.h"
@@ -45,21 +47,107 @@ void GroupView::setModel(QAbstractItemModel *model)
 {
 	QAbstractItemView::setModel(model);
 	connect(model, &QAbstractItemModel::modelReset, this, &GroupView::modelReset);
+	// sorting moves the items around, the stored positions are no good after that
+	connect(model, &QAbstractItemModel::layoutChanged, this, &GroupView::invalidateLayout);
+	connect(model, &QAbstractItemModel::rowsMoved, this, &GroupView::invalidateLayout);
+}
+
+void GroupView::invalidateLayout()
+{
+	m_layoutDirty = true;
+	scheduleDelayedItemsLayout();
 }
 
 void GroupView::dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
 							const QVector<int> &roles)
 {
-	scheduleDelayedItemsLayout();
+	// only the text, the icon and the group change the layout
+	if (!roles.isEmpty() && !roles.contains(Qt::DisplayRole) &&
+		!roles.contains(Qt::DecorationRole) && !roles.contains(GroupViewRoles::GroupRole))
+	{
+		viewport()->update();
+		return;
+	}
+	if (m_layoutDirty)
+	{
+		scheduleDelayedItemsLayout();
+		return;
+	}
+	QSet<VisualGroup *> touched;
+	for (int row = topLeft.row(); row <= bottomRight.row(); row++)
+	{
+		QModelIndex index = model()->index(row, 0);
+		auto position = itemPosition(index);
+		// moving to another group changes more than the group itself
+		if (!position ||
+			position->group->text != index.data(GroupViewRoles::GroupRole).toString())
+		{
+			invalidateLayout();
+			return;
+		}
+		touched.insert(position->group);
+	}
+	// only the row heights can change, every item keeps its row and column
+	for (auto group : touched)
+	{
+		group->update(group->items());
+	}
+	geometryCache.clear();
+	layoutGroups();
 }
+
 void GroupView::rowsInserted(const QModelIndex &parent, int start, int end)
 {
-	scheduleDelayedItemsLayout();
+	int count = end - start + 1;
+	// patching needs a layout that is current, minus the new rows
+	if (m_layoutDirty || parent.isValid() ||
+		m_itemPositions.size() + count != model()->rowCount())
+	{
+		invalidateLayout();
+		return;
+	}
+
+	QHash<VisualGroup *, QList<QModelIndex>> added;
+	for (int row = start; row <= end; row++)
+	{
+		QModelIndex index = model()->index(row, 0);
+		VisualGroup *group = category(index.data(GroupViewRoles::GroupRole).toString());
+		// a new group goes somewhere in the middle of the sorted groups
+		if (!group)
+		{
+			invalidateLayout();
+			return;
+		}
+		added[group].append(index);
+	}
+
+	for (auto group : m_groups)
+	{
+		// everything after the new rows moved down
+		for (auto &row : group->rows)
+		{
+			for (auto &index : row.items)
+			{
+				if (index.row() >= start)
+					index = model()->index(index.row() + count, 0);
+			}
+		}
+		if (!added.contains(group))
+			continue;
+		// only the groups that got new items are flowed again
+		auto items = group->items() + added[group];
+		std::sort(items.begin(), items.end(), [](const QModelIndex &a, const QModelIndex &b)
+		{ return a.row() < b.row(); });
+		group->update(items);
+	}
+	rebuildItemPositions();
+	geometryCache.clear();
+	layoutGroups();
 }
 
 void GroupView::rowsAboutToBeRemoved(const QModelIndex &parent, int start, int end)
 {
-	scheduleDelayedItemsLayout();
+	invalidateLayout();
 }
 
 class LocaleString : public QString
@@ -81,14 +169,16 @@ inline bool operator<(const LocaleString &lhs, const LocaleString &rhs)
 void GroupView::updateGeometries()
 {
 	geometryCache.clear();
-	int previousScroll = verticalScrollBar()->value();
 
 	QMap<LocaleString, VisualGroup *> cats;
+	QHash<QString, QList<QModelIndex>> groupItems;
 
+	// one pass over the model sorts all the items into their groups
 	for (int i = 0; i < model()->rowCount(); ++i)
 	{
-		const QString groupName =
-			model()->index(i, 0).data(GroupViewRoles::GroupRole).toString();
+		const QModelIndex index = model()->index(i, 0);
+		const QString groupName = index.data(GroupViewRoles::GroupRole).toString();
+		groupItems[groupName].append(index);
 		if (!cats.contains(groupName))
 		{
 			VisualGroup *old = this->category(groupName);
@@ -113,9 +203,56 @@ void GroupView::updateGeometries()
 
 	for (auto cat : m_groups)
 	{
-		cat->update();
+		cat->update(groupItems[cat->text]);
 	}
 
+	rebuildItemPositions();
+	layoutGroups();
+	m_layoutDirty = false;
+}
+
+void GroupView::rebuildItemPositions()
+{
+	m_itemPositions.fill(ItemPosition(), model()->rowCount());
+	for (auto group : m_groups)
+	{
+		for (int r = 0; r < group->rows.size(); r++)
+		{
+			auto &items = group->rows[r].items;
+			for (int c = 0; c < items.size(); c++)
+			{
+				int row = items[c].row();
+				if (row < 0 || row >= m_itemPositions.size())
+					continue;
+				auto &position = m_itemPositions[row];
+				position.group = group;
+				position.row = r;
+				position.column = c;
+			}
+		}
+	}
+}
+
+const GroupView::ItemPosition *GroupView::itemPosition(const QModelIndex &index) const
+{
+	// stale until the next layout
+	if (m_layoutDirty || !index.isValid() || index.row() >= m_itemPositions.size())
+	{
+		return nullptr;
+	}
+	const ItemPosition *position = &m_itemPositions[index.row()];
+	return position->group ? position : nullptr;
+}
+
+int GroupView::bodyTop(const VisualGroup *group) const
+{
+	return group->verticalPosition() + group->headerHeight() + 5;
+}
+
+void GroupView::layoutGroups()
+{
+	int previousScroll = verticalScrollBar()->value();
+
 	if (m_groups.isEmpty())
 	{
 		verticalScrollBar()->setRange(0, 0);
@@ -154,6 +291,7 @@ void GroupView::updateGeometries()
 
 void GroupView::modelReset()
 {
+	m_layoutDirty = true;
 	scheduleDelayedItemsLayout();
 	executeDelayedItemsLayout();
 }
@@ -173,6 +311,10 @@ bool GroupView::isIndexHidden(const QModelIndex &index) const
 
 VisualGroup *GroupView::category(const QModelIndex &index) const
 {
+	if (auto position = itemPosition(index))
+	{
+		return position->group;
+	}
 	return category(index.data(GroupViewRoles::GroupRole).toString());
 }
 
@@ -390,12 +532,20 @@ void GroupView::mouseDoubleClickEvent(QMouseEvent *event)
 void GroupView::paintEvent(QPaintEvent *event)
 {
 	executeDelayedItemsLayout();
+	// the indexes stored in the rows may be gone until the layout ran
+	if (m_layoutDirty)
+	{
+		return;
+	}
 
 	QPainter painter(this->viewport());
 
 	QStyleOptionViewItemV4 option(viewOptions());
 	option.widget = this;
 
+	// only what intersects this goes through the painter
+	const QRect area = event->rect();
+
 	int wpWidth = viewport()->width();
 	option.rect.setWidth(wpWidth);
 	for (int i = 0; i < m_groups.size(); ++i)
@@ -403,8 +553,12 @@ void GroupView::paintEvent(QPaintEvent *event)
 		VisualGroup *category = m_groups.at(i);
 		int y = category->verticalPosition();
 		y -= verticalOffset();
-		QRect backup = option.rect;
 		int height = category->totalHeight();
+		if (y > area.bottom() || y + height < area.top())
+		{
+			continue;
+		}
+		QRect backup = option.rect;
 		option.rect.setTop(y);
 		option.rect.setHeight(height);
 		option.rect.setLeft(m_leftMargin);
@@ -414,32 +568,47 @@ void GroupView::paintEvent(QPaintEvent *event)
 		option.rect = backup;
 	}
 
-	for (int i = 0; i < model()->rowCount(); ++i)
+	for (auto group : m_groups)
 	{
-		const QModelIndex index = model()->index(i, 0);
-		if (isIndexHidden(index))
+		if (group->collapsed)
 		{
 			continue;
 		}
-		Qt::ItemFlags flags = index.flags();
-		option.rect = visualRect(index);
-		option.features |=
-			QStyleOptionViewItemV2::WrapText; // FIXME: what is the meaning of this anyway?
-		if (flags & Qt::ItemIsSelectable && selectionModel()->isSelected(index))
-		{
-			option.state |= selectionModel()->isSelected(index) ? QStyle::State_Selected
-																: QStyle::State_None;
-		}
-		else
+		int top = bodyTop(group) - verticalOffset();
+		if (top > area.bottom() || top + group->contentHeight() < area.top())
 		{
-			option.state &= ~QStyle::State_Selected;
+			continue;
 		}
-		option.state |= (index == currentIndex()) ? QStyle::State_HasFocus : QStyle::State_None;
-		if (!(flags & Qt::ItemIsEnabled))
+		for (auto &row : group->rows)
 		{
-			option.state &= ~QStyle::State_Enabled;
+			int rowTop = top + row.top;
+			if (rowTop > area.bottom() || rowTop + row.height < area.top())
+			{
+				continue;
+			}
+			for (auto &index : row.items)
+			{
+				Qt::ItemFlags flags = index.flags();
+				option.rect = visualRect(index);
+				option.features |=
+					QStyleOptionViewItemV2::WrapText; // FIXME: what is the meaning of this anyway?
+				if (flags & Qt::ItemIsSelectable && selectionModel()->isSelected(index))
+				{
+					option.state |= selectionModel()->isSelected(index) ? QStyle::State_Selected
+																		: QStyle::State_None;
+				}
+				else
+				{
+					option.state &= ~QStyle::State_Selected;
+				}
+				option.state |= (index == currentIndex()) ? QStyle::State_HasFocus : QStyle::State_None;
+				if (!(flags & Qt::ItemIsEnabled))
+				{
+					option.state &= ~QStyle::State_Enabled;
+				}
+				itemDelegate()->paint(&painter, option, index);
+			}
 		}
-		itemDelegate()->paint(&painter, option, index);
 	}
 
 	/*
@@ -610,13 +779,16 @@ QRect GroupView::geometryRect(const QModelIndex &index) const
 		return *geometryCache[row];
 	}
 
-	const VisualGroup *cat = category(index);
-	QPair<int, int> pos = cat->positionOf(index);
-	int x = pos.first;
-	// int y = pos.second;
+	auto position = itemPosition(index);
+	if (!position)
+	{
+		return QRect();
+	}
+	const VisualGroup *cat = position->group;
+	int x = position->column;
 
 	QRect out;
-	out.setTop(cat->verticalPosition() + cat->headerHeight() + 5 + cat->rowTopOf(index));
+	out.setTop(bodyTop(cat) + cat->rows[position->row].top);
 	out.setLeft(m_spacing + x * (itemWidth() + m_spacing));
 	out.setSize(itemDelegate()->sizeHint(viewOptions(), index));
 	geometryCache.insert(row, new QRect(out));
@@ -625,13 +797,34 @@ QRect GroupView::geometryRect(const QModelIndex &index) const
 
 QModelIndex GroupView::indexAt(const QPoint &point) const
 {
-	for (int i = 0; i < model()->rowCount(); ++i)
+	if (m_layoutDirty)
+	{
+		return QModelIndex();
+	}
+	const QPoint pos = point + offset();
+	for (auto group : m_groups)
 	{
-		QModelIndex index = model()->index(i, 0);
-		if (visualRect(index).contains(point))
+		int top = bodyTop(group);
+		if (group->collapsed || pos.y() < top || pos.y() >= top + group->contentHeight())
+		{
+			continue;
+		}
+		// the last row that starts above the point
+		auto row = std::upper_bound(group->rows.cbegin(), group->rows.cend(), pos.y() - top,
+									[](int y, const VisualRow &row)
+		{ return y < row.top; });
+		if (row == group->rows.cbegin())
+		{
+			return QModelIndex();
+		}
+		--row;
+		int column = (pos.x() - m_spacing) / (itemWidth() + m_spacing);
+		if (pos.x() < m_spacing || column >= row->size())
 		{
-			return index;
+			return QModelIndex();
 		}
+		QModelIndex index = row->items[column];
+		return geometryRect(index).contains(pos) ? index : QModelIndex();
 	}
 	return QModelIndex();
 }
@@ -639,14 +832,34 @@ QModelIndex GroupView::indexAt(const QPoint &point) const
 void GroupView::setSelection(const QRect &rect,
 							 const QItemSelectionModel::SelectionFlags commands)
 {
-	for (int i = 0; i < model()->rowCount(); ++i)
+	executeDelayedItemsLayout();
+	if (m_layoutDirty)
+	{
+		return;
+	}
+	const QRect area = rect.translated(offset());
+	for (auto group : m_groups)
 	{
-		QModelIndex index = model()->index(i, 0);
-		QRect itemRect = visualRect(index);
-		if (itemRect.intersects(rect))
+		int top = bodyTop(group);
+		if (group->collapsed || top > area.bottom() || top + group->contentHeight() < area.top())
+		{
+			continue;
+		}
+		for (auto &row : group->rows)
 		{
-			selectionModel()->select(index, commands);
-			update(itemRect.translated(-offset()));
+			if (top + row.top > area.bottom() || top + row.top + row.height < area.top())
+			{
+				continue;
+			}
+			for (auto &index : row.items)
+			{
+				QRect itemRect = visualRect(index);
+				if (itemRect.intersects(rect))
+				{
+					selectionModel()->select(index, commands);
+					update(itemRect.translated(-offset()));
+				}
+			}
 		}
 	}
 }
@@ -4,6 +4,7 @@
 #include <QLineEdit>
 #include <QScrollBar>
 #include <QCache>
+#include <QVector>
 
 struct GroupViewRoles
 {
@@ -58,6 +59,8 @@ slots:
 	virtual void rowsAboutToBeRemoved(const QModelIndex &parent, int start, int end) override;
 	virtual void updateGeometries() override;
 	void modelReset();
+	/// the model changed in a way the layout can't follow, lay it all out again
+	void invalidateLayout();
 
 protected:
 	virtual bool isIndexHidden(const QModelIndex &index) const override;
@@ -79,6 +82,18 @@ private:
 	friend struct VisualGroup;
 	QList<VisualGroup *> m_groups;
 
+	/// where an item is in the layout
+	struct ItemPosition
+	{
+		VisualGroup *group = nullptr;
+		int row = -1;
+		int column = -1;
+	};
+	/// layout positions, by model row
+	QVector<ItemPosition> m_itemPositions;
+	/// true if the model changed since the last layout and it can't be patched
+	bool m_layoutDirty = true;
+
 	// geometry
 	int m_leftMargin = 5;
 	int m_rightMargin = 5;
@@ -101,6 +116,7 @@ private:
 	VisualGroup *category(const QModelIndex &index) const;
 	VisualGroup *category(const QString &cat) const;
 	VisualGroup *categoryAt(const QPoint &pos) const;
+	const ItemPosition *itemPosition(const QModelIndex &index) const;
 
 	int itemsPerRow() const
 	{
@@ -109,6 +125,12 @@ private:
 	int contentWidth() const;
 
 private: /* methods */
+	/// fill m_itemPositions from the rows of the groups
+	void rebuildItemPositions();
+	/// stack the groups and set up the scroll bar
+	void layoutGroups();
+	/// top of the first row of the group, in geometry coordinates
+	int bodyTop(const VisualGroup *group) const;
 	int itemWidth() const;
 	int calculateItemsPerRow() const;
 	int verticalScrollToValue(const QModelIndex &index, const QRect &rect,
@@ -16,9 +16,8 @@ VisualGroup::VisualGroup(const VisualGroup *other)
 {
 }
 
-void VisualGroup::update()
+void VisualGroup::update(const QList<QModelIndex> &temp_items)
 {
-	auto temp_items = items();
 	auto itemsPerRow = view->itemsPerRow();
 
 	int numRows = qMax(1, qCeil((qreal)temp_items.size() / (qreal)itemsPerRow));
@@ -289,13 +288,9 @@ int VisualGroup::verticalPosition() const
 QList<QModelIndex> VisualGroup::items() const
 {
 	QList<QModelIndex> indices;
-	for (int i = 0; i < view->model()->rowCount(); ++i)
+	for (auto &row : rows)
 	{
-		const QModelIndex index = view->model()->index(i, 0);
-		if (index.data(GroupViewRoles::GroupRole).toString() == text)
-		{
-			indices.append(index);
-		}
+		indices.append(row.items);
 	}
 	return indices;
 }
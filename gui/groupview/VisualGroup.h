@@ -39,8 +39,8 @@ struct VisualGroup
 	int m_verticalPosition = 0;
 
 /* logic */
-	/// update the internal list of items and flow them into the rows.
-	void update();
+	/// flow the given items (in model order) into the rows.
+	void update(const QList<QModelIndex> &items);
 
 	/// draw the header at y-position.
 	void drawHeader(QPainter *painter, const QStyleOptionViewItem &option);
@@ -85,6 +85,7 @@ struct VisualGroup
 	/// shoot! BANG! what did we hit?
 	HitResults hitScan (const QPoint &pos) const;
 
+	/// the items of the group, as they are laid out
 	QList<QModelIndex> items() const;
 };
 
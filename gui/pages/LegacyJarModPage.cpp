@@ -113,7 +113,9 @@ void LegacyJarModPage::on_addForgeBtn_clicked()
 		if (entry->stale)
 		{
 			NetJob *fjob = new NetJob("Forge download");
-			fjob->addNetAction(CacheDownload::make(forge->universal_url, entry));
+			auto dl = CacheDownload::make(forge->universal_url, entry);
+			dl->m_hasher.expectHex(forge->universal_checksum);
+			fjob->addNetAction(dl);
 			ProgressDialog dlg(this);
 			dlg.exec(fjob);
 			if (dlg.result() == QDialog::Accepted)
@@ -6,8 +6,11 @@
 #include <QIcon>
 #include <QScrollBar>
 #include <QShortcut>
+#include <algorithm>
 
 #include "logic/MinecraftProcess.h"
+#include "logic/LogModel.h"
+#include "pathutils.h"
 #include "gui/GuiUtil.h"
 
 LogPage::LogPage(MinecraftProcess *proc, QWidget *parent)
@@ -17,9 +20,14 @@ LogPage::LogPage(MinecraftProcess *proc, QWidget *parent)
 	ui->tabWidget->tabBar()->hide();
 	connect(m_process, SIGNAL(log(QString, MessageLevel::Enum)), this,
 			SLOT(write(QString, MessageLevel::Enum)));
+	connect(m_process, SIGNAL(logLines(QList<LogLine>)), this, SLOT(writeLines(QList<LogLine>)));
 
-	// create the format and set its font
-	defaultFormat = new QTextCharFormat(ui->text->currentCharFormat());
+	m_model = new LogModel(MMC->settings()->get("ConsoleMaxLines").toInt(), this);
+	m_model->setSpillFile(PathCombine(m_process->instance()->instanceRoot(), "console.log"));
+	m_proxy = new LogFilterModel(m_model, this);
+	ui->text->setModel(m_proxy);
+
+	// set the font
 	QString fontFamily = MMC->settings()->get("ConsoleFont").toString();
 	bool conversionOk = false;
 	int fontSize = MMC->settings()->get("ConsoleFontSize").toInt(&conversionOk);
@@ -27,7 +35,8 @@ LogPage::LogPage(MinecraftProcess *proc, QWidget *parent)
 	{
 		fontSize = 11;
 	}
-	defaultFormat->setFont(QFont(fontFamily, fontSize));
+	ui->text->setFont(QFont(fontFamily, fontSize));
+	m_model->setFont(ui->text->font());
 
 	auto findShortcut = new QShortcut(QKeySequence(QKeySequence::Find), this);
 	connect(findShortcut, SIGNAL(activated()), SLOT(findActivated()));
@@ -36,12 +45,14 @@ LogPage::LogPage(MinecraftProcess *proc, QWidget *parent)
 	connect(ui->searchBar, SIGNAL(returnPressed()), SLOT(on_findButton_clicked()));
 	auto findPreviousShortcut = new QShortcut(QKeySequence(QKeySequence::FindPrevious), this);
 	connect(findPreviousShortcut, SIGNAL(activated()), SLOT(findPreviousActivated()));
+	auto copyShortcut = new QShortcut(QKeySequence(QKeySequence::Copy), ui->text);
+	copyShortcut->setContext(Qt::WidgetShortcut);
+	connect(copyShortcut, SIGNAL(activated()), SLOT(copySelection()));
 }
 
 LogPage::~LogPage()
 {
 	delete ui;
-	delete defaultFormat;
 }
 
 bool LogPage::apply()
@@ -56,17 +67,17 @@ bool LogPage::shouldDisplay() const
 
 void LogPage::on_btnPaste_clicked()
 {
-	GuiUtil::uploadPaste(ui->text->toPlainText(), this);
+	GuiUtil::uploadPaste(m_model->fullText(), this);
 }
 
 void LogPage::on_btnCopy_clicked()
 {
-	GuiUtil::setClipboardText(ui->text->toPlainText());
+	GuiUtil::setClipboardText(m_model->fullText());
 }
 
 void LogPage::on_btnClear_clicked()
 {
-	ui->text->clear();
+	m_model->clear();
 }
 
 void LogPage::on_trackLogCheckbox_clicked(bool checked)
@@ -74,6 +85,28 @@ void LogPage::on_trackLogCheckbox_clicked(bool checked)
 	m_write_active = checked;
 }
 
+void LogPage::on_levelFilter_currentIndexChanged(int index)
+{
+	static const MessageLevel::Enum levels[] = {MessageLevel::Debug, MessageLevel::Info,
+												MessageLevel::Warning, MessageLevel::Error};
+	if (index >= 0 && index < 4)
+		m_proxy->setMinimumLevel(levels[index]);
+}
+
+void LogPage::copySelection()
+{
+	auto selected = ui->text->selectionModel()->selectedRows();
+	// in the order they are shown, not the order they were clicked
+	std::sort(selected.begin(), selected.end());
+	QString text;
+	for (auto &index : selected)
+	{
+		text += index.data().toString();
+		text += '\n';
+	}
+	GuiUtil::setClipboardText(text);
+}
+
 void LogPage::on_findButton_clicked()
 {
 	auto modifiers = QApplication::keyboardModifiers();
@@ -92,9 +125,8 @@ void LogPage::findActivated()
 	// focus the search bar if it doesn't have focus
 	if (!ui->searchBar->hasFocus())
 	{
-		auto searchForCursor = ui->text->textCursor();
-		auto searchForString = searchForCursor.selectedText();
-		if (searchForString.size())
+		auto searchForString = ui->text->currentIndex().data().toString();
+		if (searchForString.size() && ui->text->selectionModel()->hasSelection())
 		{
 			ui->searchBar->setText(searchForString);
 		}
@@ -105,34 +137,59 @@ void LogPage::findActivated()
 
 void LogPage::findNextActivated()
 {
-	auto toSearch = ui->searchBar->text();
-	if (toSearch.size())
-	{
-		ui->text->find(toSearch);
-	}
+	find(false);
 }
 
 void LogPage::findPreviousActivated()
+{
+	find(true);
+}
+
+void LogPage::find(bool backward)
 {
 	auto toSearch = ui->searchBar->text();
-	if (toSearch.size())
+	if (!toSearch.size())
+		return;
+	int from = ui->text->currentIndex().isValid() ? ui->text->currentIndex().row()
+												  : (backward ? m_proxy->rowCount() : -1);
+	int row = m_proxy->find(toSearch, from, backward);
+	if (row != -1)
 	{
-		ui->text->find(toSearch, QTextDocument::FindBackward);
+		auto index = m_proxy->index(row, 0);
+		ui->text->setCurrentIndex(index);
+		ui->text->scrollTo(index);
 	}
 }
 
 void LogPage::write(QString data, MessageLevel::Enum mode)
 {
+	if (data.endsWith('\n'))
+		data = data.left(data.length() - 1);
+	QList<LogLine> lines;
+	for (QString &paragraph : data.split('\n'))
+	{
+		lines.append({paragraph, mode});
+	}
+	writeLines(lines);
+}
+
+void LogPage::writeLines(QList<LogLine> lines)
+{
+	// the spill file gets everything, so copy and upload still have the whole log
+	m_model->spill(lines);
 	if (!m_write_active)
 	{
-		if (mode != MessageLevel::PrePost && mode != MessageLevel::MultiMC)
+		// only our own messages get shown
+		QList<LogLine> filtered;
+		for (auto &line : lines)
 		{
-			return;
+			if (line.level == MessageLevel::PrePost || line.level == MessageLevel::MultiMC)
+				filtered.append(line);
 		}
+		lines = filtered;
 	}
-
-	// save the cursor so it can be restored.
-	auto savedCursor = ui->text->cursor();
+	if (lines.isEmpty())
+		return;
 
 	QScrollBar *bar = ui->text->verticalScrollBar();
 	int max_bar = bar->maximum();
@@ -148,75 +205,15 @@ void LogPage::write(QString data, MessageLevel::Enum mode)
 			m_scroll_active = val_bar == max_bar;
 		}
 	}
-	if (data.endsWith('\n'))
-		data = data.left(data.length() - 1);
-	QStringList paragraphs = data.split('\n');
-	QStringList filtered;
-	for (QString &paragraph : paragraphs)
-	{
-		//TODO: implement filtering here.
-		filtered.append(paragraph);
-	}
-	QListIterator<QString> iter(filtered);
-	QTextCharFormat format(*defaultFormat);
 
-	switch(mode)
-	{
-		case MessageLevel::MultiMC:
-		{
-			format.setForeground(QColor("blue"));
-			break;
-		}
-		case MessageLevel::Debug:
-		{
-			format.setForeground(QColor("green"));
-			break;
-		}
-		case MessageLevel::Warning:
-		{
-			format.setForeground(QColor("orange"));
-			break;
-		}
-		case MessageLevel::Error:
-		{
-			format.setForeground(QColor("red"));
-			break;
-		}
-		case MessageLevel::Fatal:
-		{
-			format.setForeground(QColor("red"));
-			format.setBackground(QColor("black"));
-			break;
-		}
-		case MessageLevel::PrePost:
-		{
-			format.setForeground(QColor("grey"));
-			break;
-		}
-		case MessageLevel::Info:
-		case MessageLevel::Message:
-		default:
-		{
-			// do nothing, keep original
-		}
-	}
-
-	while (iter.hasNext())
-	{
-		// append a paragraph/line
-		auto workCursor = ui->text->textCursor();
-		workCursor.movePosition(QTextCursor::End);
-		workCursor.insertText(iter.next(), format);
-		workCursor.insertBlock();
-	}
+	m_model->append(lines);
 
 	if (isVisible())
 	{
 		if (m_scroll_active)
 		{
-			bar->setValue(bar->maximum());
+			ui->text->scrollToBottom();
 		}
 		m_last_scroll_value = bar->value();
 	}
-	ui->text->setCursor(savedCursor);
 }
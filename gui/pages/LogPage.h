@@ -24,11 +24,12 @@
 
 class EnabledItemFilter;
 class MinecraftProcess;
+class LogModel;
+class LogFilterModel;
 namespace Ui
 {
 class LogPage;
 }
-class QTextCharFormat;
 
 class LogPage : public QWidget, public BasePage
 {
@@ -64,17 +65,24 @@ private slots:
 	 * lines have to be put through this as a whole!
 	 */
 	void write(QString data, MessageLevel::Enum level = MessageLevel::MultiMC);
+	/// append a batch of lines
+	void writeLines(QList<LogLine> lines);
 	void on_btnPaste_clicked();
 	void on_btnCopy_clicked();
 	void on_btnClear_clicked();
 
 	void on_trackLogCheckbox_clicked(bool checked);
+	void on_levelFilter_currentIndexChanged(int index);
+	void copySelection();
 
 	void on_findButton_clicked();
 	void findActivated();
 	void findNextActivated();
 	void findPreviousActivated();
 
+private:
+	void find(bool backward);
+
 private:
 	Ui::LogPage *ui;
 	MinecraftProcess *m_process;
@@ -83,5 +91,6 @@ private:
 	int m_saved_offset = 0;
 	bool m_write_active = true;
 
-	QTextCharFormat * defaultFormat;
+	LogModel *m_model;
+	LogFilterModel *m_proxy;
 };
@@ -25,6 +25,7 @@
 #include "gui/Platform.h"
 #include "gui/dialogs/VersionSelectDialog.h"
 #include "gui/dialogs/CustomMessageBox.h"
+#include "gui/dialogs/ProgressDialog.h"
 
 #include "logic/NagUtils.h"
 
@@ -36,6 +37,8 @@
 
 #include "logic/tools/BaseProfiler.h"
 
+#include "logic/assets/AssetsVerifyTask.h"
+
 #include "logic/settings/SettingsObject.h"
 #include "MultiMC.h"
 
@@ -70,6 +73,27 @@ void MinecraftPage::on_maximizedCheckBox_clicked(bool checked)
 	updateCheckboxStuff();
 }
 
+void MinecraftPage::on_verifyAssetsButton_clicked()
+{
+	// everything in the object store. What's broken is downloaded again on the next update.
+	AssetsVerifyTask task;
+	task.setRemoveInvalid(true);
+	ProgressDialog progDialog(this);
+	progDialog.exec(&task);
+	if (!task.successful())
+	{
+		CustomMessageBox::selectable(this, tr("Error"), task.failReason(),
+									 QMessageBox::Warning)->show();
+		return;
+	}
+	int invalid = task.invalidObjects().size();
+	QString message = invalid
+		? tr("%1 damaged assets were removed. They will be downloaded again the next time "
+			 "an instance that uses them is launched.").arg(invalid)
+		: tr("All assets are fine.");
+	CustomMessageBox::selectable(this, tr("Verify Assets"), message,
+								 QMessageBox::Information)->show();
+}
 
 void MinecraftPage::applySettings()
 {
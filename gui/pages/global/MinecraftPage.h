@@ -62,6 +62,7 @@ private:
 private
 slots:
 	void on_maximizedCheckBox_clicked(bool checked);
+	void on_verifyAssetsButton_clicked();
 
 private:
 	Ui::MinecraftPage *ui;
@@ -26,6 +26,10 @@
 #include "QsLog.h"
 #include "QsLogDest.h"
 #include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QAtomicPointer>
 #include <QList>
 #include <QDateTime>
 #include <QtGlobal>
@@ -53,15 +57,169 @@ static const char *LevelToText(Level theLevel)
 	return LevelStrings[theLevel];
 }
 
-class LoggerImpl
+//! a message waiting for the writer thread
+struct QueuedMessage
+{
+	QAtomicPointer<QueuedMessage> next;
+	QString message;
+};
+
+//! Multiple producer, single consumer queue that never blocks the producers.
+//! An intrusive linked list with a stub node, after Dmitry Vyukov's design.
+class MessageQueue
+{
+public:
+	MessageQueue() : head(&stub), tail(&stub)
+	{
+		stub.next.store(0);
+	}
+
+	//! any thread
+	void push(QueuedMessage *node)
+	{
+		node->next.store(0);
+		QueuedMessage *prev = head.fetchAndStoreAcquire(node);
+		prev->next.storeRelease(node);
+	}
+
+	//! only the consumer. Returns null if empty, or if a push is half way done.
+	QueuedMessage *pop()
+	{
+		QueuedMessage *first = tail;
+		QueuedMessage *next = first->next.loadAcquire();
+		if (first == &stub)
+		{
+			if (!next)
+				return 0;
+			tail = next;
+			first = next;
+			next = next->next.loadAcquire();
+		}
+		if (next)
+		{
+			tail = next;
+			return first;
+		}
+		if (first != head.loadAcquire())
+			return 0;
+		// first is the last one, put the stub behind it so it can be taken out
+		push(&stub);
+		next = first->next.loadAcquire();
+		if (next)
+		{
+			tail = next;
+			return first;
+		}
+		return 0;
+	}
+
+private:
+	QAtomicPointer<QueuedMessage> head;
+	QueuedMessage *tail;
+	QueuedMessage stub;
+};
+
+//! drains the queue into the destinations, in the background
+class LoggerImpl : public QThread
 {
 public:
 	LoggerImpl() : level(InfoLevel)
 	{
+		start(QThread::LowPriority);
+	}
+	~LoggerImpl()
+	{
+		quitting.store(1);
+		wakeUp.wakeOne();
+		wait();
+		drain();
 	}
-	QMutex logMutex;
+
+	void enqueue(const QString &message)
+	{
+		auto node = new QueuedMessage;
+		node->message = message;
+		// counted before it is in the queue, so a flush() that counts it waits for it
+		unsigned int count = unsigned(pushed.fetchAndAddOrdered(1)) + 1;
+		queue.push(node);
+		// wake the writer early when a lot is coming in
+		if (count - unsigned(written.load()) == batchSize)
+			wakeUp.wakeOne();
+	}
+
+	//! write out everything that is in the queue. Any thread.
+	void drain()
+	{
+		QMutexLocker lock(&writeMutex);
+		bool wrote = false;
+		while (QueuedMessage *node = queue.pop())
+		{
+			for (auto destination : destList)
+				destination->write(node->message);
+			delete node;
+			written.fetchAndAddOrdered(1);
+			wrote = true;
+		}
+		if (wrote)
+		{
+			for (auto destination : destList)
+				destination->flush();
+			QMutexLocker writtenLock(&writtenMutex);
+			writtenCondition.wakeAll();
+		}
+	}
+
+	//! drain until everything that was pushed before the call is written.
+	//! Messages that other threads push in the meantime don't hold it up.
+	void flush()
+	{
+		const unsigned int ticket = pushed.load();
+		drain();
+		QMutexLocker lock(&writtenMutex);
+		// the counters wrap around, compare their distance
+		while (int(unsigned(written.load()) - ticket) < 0)
+		{
+			// a push is half way done and hides what is behind it for a moment
+			writtenCondition.wait(&writtenMutex, 5);
+			lock.unlock();
+			drain();
+			lock.relock();
+		}
+	}
+
+protected:
+	virtual void run()
+	{
+		while (!quitting.load())
+		{
+			{
+				QMutexLocker lock(&sleepMutex);
+				wakeUp.wait(&sleepMutex, flushInterval);
+			}
+			drain();
+		}
+	}
+
+public:
+	//! messages that wake the writer before the interval is over
+	static const int batchSize = 256;
+	//! most time a message waits in the queue, in milliseconds
+	static const unsigned long flushInterval = 100;
+
 	Level level;
+	//! guards the destinations and taking messages out of the queue
+	QMutex writeMutex;
 	DestinationList destList;
+
+	MessageQueue queue;
+	//! messages that were handed to enqueue(), and that were written out
+	QAtomicInt pushed;
+	QAtomicInt written;
+	QMutex writtenMutex;
+	QWaitCondition writtenCondition;
+	QAtomicInt quitting;
+	QMutex sleepMutex;
+	QWaitCondition wakeUp;
 };
 
 Logger::Logger() : d(new LoggerImpl)
@@ -76,6 +234,7 @@ Logger::~Logger()
 void Logger::addDestination(Destination *destination)
 {
 	assert(destination);
+	QMutexLocker lock(&d->writeMutex);
 	d->destList.push_back(destination);
 }
 
@@ -89,6 +248,11 @@ Level Logger::loggingLevel() const
 	return d->level;
 }
 
+void Logger::flush()
+{
+	d->flush();
+}
+
 //! creates the complete log message and passes it to the logger
 void Logger::Helper::writeToLog()
 {
@@ -96,8 +260,10 @@ void Logger::Helper::writeToLog()
 	const QString completeMessage(QString("%1\t%2").arg(levelName, 5).arg(buffer));
 
 	Logger &logger = Logger::instance();
-	QMutexLocker lock(&logger.d->logMutex);
-	logger.write(completeMessage);
+	logger.enqueue(completeMessage);
+	// whatever comes next may take the process down, get it on disk now
+	if (level == FatalLevel)
+		logger.flush();
 }
 
 Logger::Helper::Helper(Level logLevel) : level(logLevel), qtDebug(&buffer)
@@ -119,23 +285,17 @@ Logger::Helper::~Helper()
 	}
 }
 
-//! sends the message to all the destinations
-void Logger::write(const QString &message)
+//! queues the message for all the destinations
+void Logger::enqueue(const QString &message)
 {
-	for (DestinationList::iterator it = d->destList.begin(), endIt = d->destList.end();
-		 it != endIt; ++it)
-	{
-		if (!(*it))
-		{
-			assert(!"null log destination");
-			continue;
-		}
-		(*it)->write(message);
-	}
+	d->enqueue(message);
 }
 
 void Logger::removeDestination(Destination* destination)
 {
+	// what was logged before still goes to it
+	d->flush();
+	QMutexLocker lock(&d->writeMutex);
 	d->destList.removeAll(destination);
 }
 
@@ -60,6 +60,9 @@ public:
 	void setLoggingLevel(Level newLevel);
 	//! The default level is INFO
 	Level loggingLevel() const;
+	//! Writes everything logged so far to the destinations and flushes them.
+	//! Blocks until that is done. Messages are written in the background otherwise.
+	void flush();
 
 	//! The helper forwards the streaming to QDebug and builds the final
 	//! log message.
@@ -87,7 +90,7 @@ private:
 	Logger &operator=(const Logger &);
 	~Logger();
 
-	void write(const QString &message);
+	void enqueue(const QString &message);
 
 	LoggerImpl *d;
 };
@@ -44,7 +44,9 @@ class FileDestination : public Destination
 {
 public:
 	FileDestination(const QString &filePath);
+	virtual ~FileDestination();
 	virtual void write(const QString &message);
+	virtual void flush();
 
 private:
 	QFile mFile;
@@ -59,9 +61,19 @@ FileDestination::FileDestination(const QString &filePath)
 	mOutputStream.setDevice(&mFile);
 }
 
+FileDestination::~FileDestination()
+{
+	Logger::instance().removeDestination(this);
+}
+
 void FileDestination::write(const QString &message)
 {
-	mOutputStream << message << endl;
+	// endl would flush every line, the writer flushes once per batch instead
+	mOutputStream << message << '\n';
+}
+
+void FileDestination::flush()
+{
 	mOutputStream.flush();
 }
 
@@ -69,6 +81,10 @@ void FileDestination::write(const QString &message)
 class DebugOutputDestination : public Destination
 {
 public:
+	virtual ~DebugOutputDestination()
+	{
+		Logger::instance().removeDestination(this);
+	}
 	virtual void write(const QString &message);
 };
 
@@ -80,6 +96,10 @@ void DebugOutputDestination::write(const QString &message)
 class QDebugDestination : public Destination
 {
 public:
+	virtual ~QDebugDestination()
+	{
+		Logger::instance().removeDestination(this);
+	}
 	virtual void write(const QString &message)
 	{
 		qDebug() << message;
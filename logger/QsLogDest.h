@@ -32,11 +32,17 @@ class QString;
 namespace QsLogging
 {
 
+//! Destinations are written to from the logger's writer thread. The derived
+//! classes have to remove themselves from the logger in their destructor.
 class Destination
 {
 public:
 	virtual ~Destination();
 	virtual void write(const QString &message) = 0;
+	//! Called after every batch of messages
+	virtual void flush()
+	{
+	}
 };
 typedef std::shared_ptr<Destination> DestinationPtr;
 
@@ -43,8 +43,14 @@ InstanceFactory::InstanceFactory() : QObject(NULL)
 InstanceFactory::InstLoadError InstanceFactory::loadInstance(InstancePtr &inst,
 															 const QString &instDir)
 {
-	auto m_settings = new INISettingsObject(PathCombine(instDir, "instance.cfg"));
+	return loadInstance(inst, new INISettingsObject(PathCombine(instDir, "instance.cfg")),
+						instDir);
+}
 
+InstanceFactory::InstLoadError InstanceFactory::loadInstance(InstancePtr &inst,
+															 INISettingsObject *m_settings,
+															 const QString &instDir)
+{
 	m_settings->registerSetting("InstanceType", "Legacy");
 
 	QString inst_type = m_settings->get("InstanceType").toString();
@@ -138,6 +144,8 @@ InstanceFactory::InstCreateError InstanceFactory::copyInstance(InstancePtr &newI
 	QDir rootDir(instDir);
 
 	QLOG_DEBUG() << instDir.toUtf8();
+	// changes that are still waiting to be written would be left behind
+	oldInstance->settings().flush();
 	if (!copyPath(oldInstance->instanceRoot(), instDir))
 	{
 		rootDir.removeRecursively();
@@ -152,6 +160,7 @@ InstanceFactory::InstCreateError InstanceFactory::copyInstance(InstancePtr &newI
 		settings_obj.set("InstanceType", "OneSix");
 	if (inst_type == "LegacyFTB")
 		settings_obj.set("InstanceType", "Legacy");
+	settings_obj.flush();
 
 	oldInstance->copy(instDir);
 
@@ -24,6 +24,7 @@
 
 struct BaseVersion;
 class BaseInstance;
+class INISettingsObject;
 
 /*!
  * The \b InstanceFactory\b is a singleton that manages loading and creating instances.
@@ -99,6 +100,16 @@ public:
 	 */
 	InstLoadError loadInstance(InstancePtr &inst, const QString &instDir);
 
+	/*!
+	 * \brief Loads an instance from the given directory, with its INI file already read.
+	 * \param inst Pointer to store the loaded instance in.
+	 * \param settings The instance's settings. Taken over by the instance.
+	 * \param instDir The instance's directory.
+	 * \return An InstLoadError error code.
+	 */
+	InstLoadError loadInstance(InstancePtr &inst, INISettingsObject *settings,
+							   const QString &instDir);
+
 private:
 	InstanceFactory();
 
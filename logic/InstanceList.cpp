@@ -24,6 +24,8 @@
 #include <QJsonArray>
 #include <QXmlStreamReader>
 #include <QRegularExpression>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
 #include <pathutils.h>
 
 #include "MultiMC.h"
@@ -32,15 +34,95 @@
 #include "logic/minecraft/MinecraftVersionList.h"
 #include "logic/BaseInstance.h"
 #include "logic/InstanceFactory.h"
+#include "logic/settings/INISettingsObject.h"
+#include "logic/InstanceListSnapshot.h"
 #include "logger/QsLog.h"
 #include "gui/groupview/GroupView.h"
 
 const static int GROUP_FILE_FORMAT_VERSION = 1;
 
+namespace
+{
+struct ReadConfig
+{
+	InstanceConfig config;
+	/// nullptr if the folder has no instance.cfg
+	INISettingsObject *settings = nullptr;
+};
+
+/// Reads the instance.cfg of instance folders, on the pool threads.
+struct InstanceSettingsReader
+{
+	typedef ReadConfig result_type;
+	explicit InstanceSettingsReader(QThread *target) : target(target)
+	{
+	}
+	ReadConfig operator()(const QString &instDir) const
+	{
+		ReadConfig result;
+		// before reading, so a change made meanwhile makes it outdated rather than lost
+		result.config = InstanceConfig::stat(instDir);
+		if (!result.config.exists())
+			return result;
+		result.settings = new INISettingsObject(PathCombine(instDir, "instance.cfg"));
+		result.config.contents = result.settings->contents();
+		// the instance using it lives there
+		result.settings->moveToThread(target);
+		return result;
+	}
+	QThread *target;
+};
+
+/// Reads the modpack records from one FTB pack list, on the pool threads.
+struct FTBPackListReader
+{
+	typedef QList<FTBRecord> result_type;
+	FTBPackListReader(const QString &packsPath, const QString &dataPath)
+		: packsPath(packsPath), dataPath(dataPath)
+	{
+	}
+	QList<FTBRecord> operator()(const QString &filename) const;
+	QString packsPath;
+	QString dataPath;
+};
+}
+
+/// all the instance settings, read in parallel. Take the results in order with resultAt().
+static QFuture<ReadConfig> readInstanceSettings(const QStringList &instDirs, QThread *target)
+{
+	return QtConcurrent::mapped(instDirs, InstanceSettingsReader(target));
+}
+
+static QStringList listInstanceFolders(const QString &instDir)
+{
+	QStringList instDirs;
+	QDirIterator iter(instDir, QDir::Dirs | QDir::NoDot | QDir::NoDotDot | QDir::Readable,
+					  QDirIterator::FollowSymlinks);
+	while (iter.hasNext())
+	{
+		instDirs.append(iter.next());
+	}
+	return instDirs;
+}
+
+/// what the instance configs look like on disk now, without reading them
+static QList<InstanceConfig> statInstanceFolders(const QString &instDir)
+{
+	QList<InstanceConfig> configs;
+	for (auto dir : listInstanceFolders(instDir))
+	{
+		auto config = InstanceConfig::stat(dir);
+		if (config.exists())
+			configs.append(config);
+	}
+	return configs;
+}
+
 InstanceList::InstanceList(const QString &instDir, QObject *parent)
 	: QAbstractListModel(parent), m_instDir(instDir)
 {
 	connect(MMC, &MultiMC::aboutToQuit, this, &InstanceList::saveGroupList);
+	connect(&m_revalidate_watcher, SIGNAL(finished()), SLOT(snapshotRevalidated()));
 
 	if (!QDir::current().exists(m_instDir))
 	{
@@ -299,106 +381,130 @@ QSet<FTBRecord> InstanceList::discoverFTBInstances()
 		return records;
 	}
 	dir.cd("ModPacks");
-	auto allFiles = dir.entryList(QDir::Readable | QDir::Files, QDir::Name);
-	for (auto filename : allFiles)
+	QStringList packLists;
+	for (auto filename : dir.entryList(QDir::Readable | QDir::Files, QDir::Name))
 	{
-		if (!filename.endsWith(".xml"))
-			continue;
-		auto fpath = dir.absoluteFilePath(filename);
-		QFile f(fpath);
-		QLOG_INFO() << "Discovering FTB instances -- " << fpath;
-		if (!f.open(QFile::ReadOnly))
-			continue;
+		if (filename.endsWith(".xml"))
+			packLists.append(filename);
+	}
+	// the pack lists are read in parallel
+	auto results = QtConcurrent::blockingMapped<QList<QList<FTBRecord>>>(
+		packLists, FTBPackListReader(dir.absolutePath(), dataDir.absolutePath()));
+	for (auto result : results)
+	{
+		for (auto record : result)
+			records.insert(record);
+	}
+	return records;
+}
+
+QList<FTBRecord> FTBPackListReader::operator()(const QString &filename) const
+{
+	QList<FTBRecord> records;
+	QDir dir(packsPath);
+	QDir dataDir(dataPath);
+	auto fpath = dir.absoluteFilePath(filename);
+	QFile f(fpath);
+	QLOG_INFO() << "Discovering FTB instances -- " << fpath;
+	if (!f.open(QFile::ReadOnly))
+		return records;
 
-		// read the FTB packs XML.
-		QXmlStreamReader reader(&f);
-		while (!reader.atEnd())
+	// read the FTB packs XML.
+	QXmlStreamReader reader(&f);
+	while (!reader.atEnd())
+	{
+		switch (reader.readNext())
 		{
-			switch (reader.readNext())
-			{
-			case QXmlStreamReader::StartElement:
+		case QXmlStreamReader::StartElement:
+		{
+			if (reader.name() == "modpack")
 			{
-				if (reader.name() == "modpack")
+				QXmlStreamAttributes attrs = reader.attributes();
+				FTBRecord record;
+				record.dirName = attrs.value("dir").toString();
+				record.instanceDir = dataDir.absoluteFilePath(record.dirName);
+				record.templateDir = dir.absoluteFilePath(record.dirName);
+				QDir test(record.instanceDir);
+				QLOG_DEBUG() << dataDir.absolutePath() << record.instanceDir << record.dirName;
+				if (!test.exists())
+					continue;
+				record.name = attrs.value("name").toString();
+				record.logo = attrs.value("logo").toString();
+				auto customVersions = attrs.value("customMCVersions");
+				if(!customVersions.isNull())
 				{
-					QXmlStreamAttributes attrs = reader.attributes();
-					FTBRecord record;
-					record.dirName = attrs.value("dir").toString();
-					record.instanceDir = dataDir.absoluteFilePath(record.dirName);
-					record.templateDir = dir.absoluteFilePath(record.dirName);
-					QDir test(record.instanceDir);
-					QLOG_DEBUG() << dataDir.absolutePath() << record.instanceDir << record.dirName;
-					if (!test.exists())
-						continue;
-					record.name = attrs.value("name").toString();
-					record.logo = attrs.value("logo").toString();
-					auto customVersions = attrs.value("customMCVersions");
-					if(!customVersions.isNull())
+					QMap<QString, QString> versionMatcher;
+					QString customVersionsStr = customVersions.toString();
+					QStringList list = customVersionsStr.split(';');
+					for(auto item: list)
 					{
-						QMap<QString, QString> versionMatcher;
-						QString customVersionsStr = customVersions.toString();
-						QStringList list = customVersionsStr.split(';');
-						for(auto item: list)
+						auto segment = item.split('^');
+						if(segment.size() != 2)
 						{
-							auto segment = item.split('^');
-							if(segment.size() != 2)
-							{
-								QLOG_ERROR() << "FTB: Segment of size < 2 in " << customVersionsStr;
-								continue;
-							}
-							versionMatcher[segment[0]] = segment[1];
-						}
-						auto actualVersion = attrs.value("version").toString();
-						if(versionMatcher.contains(actualVersion))
-						{
-							record.mcVersion = versionMatcher[actualVersion];
-						}
-						else
-						{
-							record.mcVersion = attrs.value("mcVersion").toString();
+							QLOG_ERROR() << "FTB: Segment of size < 2 in " << customVersionsStr;
+							continue;
 						}
+						versionMatcher[segment[0]] = segment[1];
+					}
+					auto actualVersion = attrs.value("version").toString();
+					if(versionMatcher.contains(actualVersion))
+					{
+						record.mcVersion = versionMatcher[actualVersion];
 					}
 					else
 					{
 						record.mcVersion = attrs.value("mcVersion").toString();
 					}
-					record.description = attrs.value("description").toString();
-					records.insert(record);
 				}
-				break;
-			}
-			case QXmlStreamReader::EndElement:
-				break;
-			case QXmlStreamReader::Characters:
-				break;
-			default:
-				break;
+				else
+				{
+					record.mcVersion = attrs.value("mcVersion").toString();
+				}
+				record.description = attrs.value("description").toString();
+				records.append(record);
 			}
+			break;
+		}
+		case QXmlStreamReader::EndElement:
+			break;
+		case QXmlStreamReader::Characters:
+			break;
+		default:
+			break;
 		}
-		f.close();
 	}
+	f.close();
 	return records;
 }
 
 void InstanceList::loadFTBInstances(QMap<QString, QString> &groupMap,
 									QList<InstancePtr> &tempList)
 {
-	auto records = discoverFTBInstances();
+	auto records = discoverFTBInstances().toList();
 	if (!records.size())
 	{
 		QLOG_INFO() << "No FTB instances to load.";
 		return;
 	}
 	QLOG_INFO() << "Loading FTB instances! -- got " << records.size();
-	// process the records we acquired.
+	QStringList instDirs;
 	for (auto record : records)
 	{
+		instDirs.append(record.instanceDir);
+	}
+	auto settingsFuture = readInstanceSettings(instDirs, thread());
+	// process the records we acquired.
+	for (int i = 0; i < records.size(); i++)
+	{
+		auto &record = records[i];
 		QLOG_INFO() << "Loading FTB instance from " << record.instanceDir;
 		QString iconKey = record.logo;
 		iconKey.remove(QRegularExpression("\\..*"));
 		MMC->icons()->addIcon(iconKey, iconKey, PathCombine(record.templateDir, record.logo),
 							  MMCIcon::Transient);
 
-		if (!QFileInfo(PathCombine(record.instanceDir, "instance.cfg")).exists())
+		auto settings = settingsFuture.resultAt(i).settings;
+		if (!settings)
 		{
 			QLOG_INFO() << "Converting " << record.name << " as new.";
 			InstancePtr instPtr;
@@ -430,7 +536,7 @@ void InstanceList::loadFTBInstances(QMap<QString, QString> &groupMap,
 		{
 			QLOG_INFO() << "Loading existing " << record.name;
 			InstancePtr instPtr;
-			auto error = InstanceFactory::get().loadInstance(instPtr, record.instanceDir);
+			auto error = InstanceFactory::get().loadInstance(instPtr, settings, record.instanceDir);
 			if (!instPtr || error != InstanceFactory::NoLoadError)
 				continue;
 			instPtr->setGroupInitial("FTB");
@@ -452,28 +558,171 @@ InstanceList::InstListError InstanceList::loadList()
 	QMap<QString, QString> groupMap;
 	loadGroupList(groupMap);
 
+	// a check of an older snapshot would only get in the way now
+	m_revalidating = false;
+	m_snapshot.clear();
+
+	// the folders are read again, they have to have the latest changes
+	for (auto instance : m_instances)
+	{
+		instance->settings().flush();
+	}
+
 	QList<InstancePtr> tempList;
 	{
-		QDirIterator iter(m_instDir, QDir::Dirs | QDir::NoDot | QDir::NoDotDot | QDir::Readable,
-						  QDirIterator::FollowSymlinks);
-		while (iter.hasNext())
+		QStringList instDirs = listInstanceFolders(m_instDir);
+		// the configs are read on the thread pool, the instances are made here as they come in
+		auto settingsFuture = readInstanceSettings(instDirs, thread());
+		for (int i = 0; i < instDirs.size(); i++)
 		{
-			QString subDir = iter.next();
-			if (!QFileInfo(PathCombine(subDir, "instance.cfg")).exists())
+			auto read = settingsFuture.resultAt(i);
+			if (!read.settings)
 				continue;
+			QString subDir = instDirs[i];
 			QLOG_INFO() << "Loading MultiMC instance from " << subDir;
 			InstancePtr instPtr;
-			auto error = InstanceFactory::get().loadInstance(instPtr, subDir);
+			auto error = InstanceFactory::get().loadInstance(instPtr, read.settings, subDir);
 			if(!continueProcessInstance(instPtr, error, subDir, groupMap))
 				continue;
 			tempList.append(instPtr);
+			m_snapshot.append(read.config);
 		}
 	}
+	InstanceListSnapshot(snapshotPath()).save(m_snapshot);
 
 	if (MMC->settings()->get("TrackFTBInstances").toBool())
 	{
 		loadFTBInstances(groupMap, tempList);
 	}
+	resetInstances(tempList);
+	return NoError;
+}
+
+InstanceList::InstListError InstanceList::loadCachedList()
+{
+	QList<InstanceConfig> configs;
+	if (!InstanceListSnapshot(snapshotPath()).load(configs))
+		return loadList();
+
+	QMap<QString, QString> groupMap;
+	loadGroupList(groupMap);
+
+	m_snapshot.clear();
+	QList<InstancePtr> tempList;
+	for (auto &config : configs)
+	{
+		QLOG_INFO() << "Loading MultiMC instance from the snapshot of " << config.instDir;
+		auto settings =
+			new INISettingsObject(PathCombine(config.instDir, "instance.cfg"), config.contents);
+		// until the snapshot is revalidated, don't write anything based on it
+		settings->setMayBeOutdated();
+		InstancePtr instPtr;
+		auto error = InstanceFactory::get().loadInstance(instPtr, settings, config.instDir);
+		if(!continueProcessInstance(instPtr, error, config.instDir, groupMap))
+			continue;
+		tempList.append(instPtr);
+		m_snapshot.append(config);
+	}
+
+	if (MMC->settings()->get("TrackFTBInstances").toBool())
+	{
+		loadFTBInstances(groupMap, tempList);
+	}
+	resetInstances(tempList);
+
+	// the snapshot may be outdated. Check it without holding up the start.
+	m_revalidating = true;
+	m_revalidate_watcher.setFuture(QtConcurrent::run(statInstanceFolders, m_instDir));
+	return NoError;
+}
+
+void InstanceList::snapshotRevalidated()
+{
+	if (!m_revalidating)
+		return;
+	m_revalidating = false;
+
+	QHash<QString, InstanceConfig> gone;
+	for (auto &config : m_snapshot)
+	{
+		gone.insert(config.instDir, config);
+	}
+	QStringList changed;
+	for (auto &config : m_revalidate_watcher.result())
+	{
+		auto iter = gone.find(config.instDir);
+		if (iter == gone.end() || !iter->matches(config))
+			changed.append(config.instDir);
+		if (iter != gone.end())
+			gone.erase(iter);
+	}
+	if (changed.isEmpty() && gone.isEmpty())
+		return;
+	QLOG_INFO() << "Instance list snapshot is outdated:" << changed.size() << "changed,"
+				<< gone.size() << "removed";
+
+	// drops the instance in the folder from the list. false if it can't be dropped now.
+	auto dropInstance = [this](const QString &instDir) -> bool
+	{
+		for (int i = 0; i < m_instances.size(); i++)
+		{
+			if (m_instances[i]->instanceRoot() != instDir)
+				continue;
+			if (m_instances[i]->isRunning())
+				return false;
+			beginRemoveRows(QModelIndex(), i, i);
+			m_instances.removeAt(i);
+			endRemoveRows();
+			break;
+		}
+		for (int i = 0; i < m_snapshot.size(); i++)
+		{
+			if (m_snapshot[i].instDir == instDir)
+			{
+				m_snapshot.removeAt(i);
+				break;
+			}
+		}
+		return true;
+	};
+
+	for (auto instDir : gone.keys())
+	{
+		dropInstance(instDir);
+	}
+
+	QMap<QString, QString> groupMap;
+	loadGroupList(groupMap);
+	auto settingsFuture = readInstanceSettings(changed, thread());
+	for (int i = 0; i < changed.size(); i++)
+	{
+		auto read = settingsFuture.resultAt(i);
+		if (!dropInstance(changed[i]))
+		{
+			delete read.settings;
+			continue;
+		}
+		if (!read.settings)
+			continue;
+		QLOG_INFO() << "Reloading MultiMC instance from " << changed[i];
+		InstancePtr instPtr;
+		auto error = InstanceFactory::get().loadInstance(instPtr, read.settings, changed[i]);
+		if(!continueProcessInstance(instPtr, error, changed[i], groupMap))
+			continue;
+		add(instPtr);
+		m_snapshot.append(read.config);
+	}
+	InstanceListSnapshot(snapshotPath()).save(m_snapshot);
+	emit dataIsInvalid();
+}
+
+QString InstanceList::snapshotPath() const
+{
+	return PathCombine(m_instDir, "instances.snapshot");
+}
+
+void InstanceList::resetInstances(const QList<InstancePtr> &tempList)
+{
 	beginResetModel();
 	m_instances.clear();
 	for(auto inst: tempList)
@@ -488,7 +737,6 @@ InstanceList::InstListError InstanceList::loadList()
 	}
 	endResetModel();
 	emit dataIsInvalid();
-	return NoError;
 }
 
 /// Clear all instances. Triggers notifications.
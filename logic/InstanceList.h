@@ -20,8 +20,10 @@
 #include <QSet>
 #include <gui/groupview/GroupedProxyModel.h>
 #include <QIcon>
+#include <QFutureWatcher>
 
 #include "logic/BaseInstance.h"
+#include "logic/InstanceListSnapshot.h"
 
 class BaseInstance;
 
@@ -54,10 +56,13 @@ private:
 	void loadGroupList(QMap<QString, QString> &groupList);
 	QSet<FTBRecord> discoverFTBInstances();
 	void loadFTBInstances(QMap<QString, QString> &groupMap, QList<InstancePtr> & tempList);
+	void resetInstances(const QList<InstancePtr> &tempList);
+	QString snapshotPath() const;
 
 private
 slots:
 	void saveGroupList();
+	void snapshotRevalidated();
 
 public:
 	explicit InstanceList(const QString &instDir, QObject *parent = 0);
@@ -133,6 +138,13 @@ slots:
 	 */
 	InstListError loadList();
 
+	/*!
+	 * \brief Loads the instance list from the snapshot of the last load, if there is one.
+	 * The instances that changed since are reloaded after a check in the background.
+	 * Triggers notifications.
+	 */
+	InstListError loadCachedList();
+
 private
 slots:
 	void propertiesChanged(BaseInstance *inst);
@@ -149,6 +161,11 @@ protected:
 	QString m_instDir;
 	QList<InstancePtr> m_instances;
 	QSet<QString> m_groups;
+
+	/// configs of the loaded MultiMC instances, as they were read
+	QList<InstanceConfig> m_snapshot;
+	QFutureWatcher<QList<InstanceConfig>> m_revalidate_watcher;
+	bool m_revalidating = false;
 };
 
 class InstanceProxyModel : public GroupedProxyModel
@@ -0,0 +1,89 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "InstanceListSnapshot.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <pathutils.h>
+#include "logger/QsLog.h"
+
+static const quint32 snapshotMagic = 0x4d4d494c; // "MMIL"
+static const quint32 snapshotVersion = 1;
+
+InstanceConfig InstanceConfig::stat(const QString &instDir)
+{
+	InstanceConfig config;
+	config.instDir = instDir;
+	QFileInfo info(PathCombine(instDir, "instance.cfg"));
+	if (info.isFile())
+	{
+		config.size = info.size();
+		config.mtime = info.lastModified().toMSecsSinceEpoch();
+	}
+	return config;
+}
+
+InstanceListSnapshot::InstanceListSnapshot(QString path) : m_path(path)
+{
+}
+
+bool InstanceListSnapshot::load(QList<InstanceConfig> &configs) const
+{
+	QFile file(m_path);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	QDataStream in(&file);
+	quint32 magic, version, count;
+	in >> magic >> version >> count;
+	if (in.status() != QDataStream::Ok || magic != snapshotMagic || version != snapshotVersion)
+		return false;
+	configs.clear();
+	// no reserve(), the count of a damaged file could be anything
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		InstanceConfig config;
+		QMap<QString, QVariant> &contents = config.contents;
+		in >> config.instDir >> config.size >> config.mtime >> contents;
+		configs.append(config);
+	}
+	if (in.status() != QDataStream::Ok)
+	{
+		QLOG_WARN() << "Instance list snapshot" << m_path << "is damaged, ignoring it";
+		configs.clear();
+		return false;
+	}
+	return true;
+}
+
+void InstanceListSnapshot::save(const QList<InstanceConfig> &configs) const
+{
+	QSaveFile file(m_path);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		QLOG_ERROR() << "Failed to save the instance list snapshot" << m_path;
+		return;
+	}
+	QDataStream out(&file);
+	out << snapshotMagic << snapshotVersion << quint32(configs.size());
+	for (auto &config : configs)
+	{
+		const QMap<QString, QVariant> &contents = config.contents;
+		out << config.instDir << config.size << config.mtime << contents;
+	}
+	file.commit();
+}
@@ -0,0 +1,61 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QList>
+
+#include "logic/settings/INIFile.h"
+
+/// The instance.cfg of an instance, as it was when it was read.
+struct InstanceConfig
+{
+	QString instDir;
+	qint64 size = -1;
+	qint64 mtime = 0;
+	INIFile contents;
+
+	bool exists() const
+	{
+		return size >= 0;
+	}
+
+	/// true if the file on disk is still the one described by this
+	bool matches(const InstanceConfig &other) const
+	{
+		return size == other.size && mtime == other.mtime;
+	}
+
+	/// size and modification time of the instance.cfg in instDir, without its contents
+	static InstanceConfig stat(const QString &instDir);
+};
+
+/**
+ * The configs of all the instances in an instance folder, from the last time they were
+ * loaded. Lets the instance list show up without reading every instance.cfg first.
+ */
+class InstanceListSnapshot
+{
+public:
+	explicit InstanceListSnapshot(QString path);
+
+	/// false if there is no usable snapshot
+	bool load(QList<InstanceConfig> &configs) const;
+	void save(const QList<InstanceConfig> &configs) const;
+
+private:
+	QString m_path;
+};
@@ -0,0 +1,176 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "JarBuildCache.h"
+#include <pathutils.h>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QUuid>
+#include "logger/QsLog.h"
+
+#include <algorithm>
+
+// bump when the way jars are built changes, so old builds don't get used
+static const char *keyVersion = "1";
+// next to every entry, when it was last stored or fetched
+static const QString lastUsedSuffix = ".lastused";
+
+JarBuildCache::Key::Key() : m_hash(new QCryptographicHash(QCryptographicHash::Sha1))
+{
+	m_hash->addData(keyVersion);
+}
+
+void JarBuildCache::Key::addPolicy(const QString &policy)
+{
+	m_hash->addData("policy:" + policy.toUtf8() + '\0');
+}
+
+bool JarBuildCache::Key::addFile(const QFileInfo &file)
+{
+	m_hash->addData("file:" + file.fileName().toUtf8() + '\0');
+	return addContent(file.absoluteFilePath());
+}
+
+bool JarBuildCache::Key::addFolder(const QFileInfo &folder)
+{
+	m_hash->addData("folder:" + folder.fileName().toUtf8() + '\0');
+	QDir dir(folder.absoluteFilePath());
+	QStringList files;
+	QDirIterator iter(dir.path(), QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+	while (iter.hasNext())
+	{
+		files.append(dir.relativeFilePath(iter.next()));
+	}
+	// the iteration order depends on the file system
+	files.sort();
+	for (auto file : files)
+	{
+		m_hash->addData(file.toUtf8() + '\0');
+		if (!addContent(dir.filePath(file)))
+			return false;
+	}
+	return true;
+}
+
+bool JarBuildCache::Key::addContent(const QString &path)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	m_hash->addData(QByteArray::number(file.size()) + '\0');
+	return m_hash->addData(&file);
+}
+
+QString JarBuildCache::Key::result() const
+{
+	return m_hash->result().toHex();
+}
+
+JarBuildCache::JarBuildCache(QString path) : m_path(path)
+{
+}
+
+QString JarBuildCache::entryPath(const Key &key) const
+{
+	return PathCombine(m_path, key.result() + ".jar");
+}
+
+bool JarBuildCache::fetch(const Key &key, const QString &target)
+{
+	QString entry = entryPath(key);
+	if (!QFile::exists(entry))
+		return false;
+	if (QFile::exists(target) && !QFile::remove(target))
+		return false;
+	// entries get pruned, and instance jars get rebuilt. No symlinks either way.
+	if (linkOrCopyFile(entry, target, false) == FileLink_Failed)
+	{
+		QLOG_WARN() << "Failed to use the cached build" << entry << "for" << target;
+		return false;
+	}
+	QLOG_INFO() << "Using the cached build" << entry << "for" << target;
+	markUsed(entry);
+	return true;
+}
+
+void JarBuildCache::store(const Key &key, const QString &built)
+{
+	if (!ensureFolderPathExists(m_path))
+		return;
+	// it only shows up under its name once it's complete
+	QString entry = entryPath(key);
+	QString temp = PathCombine(m_path, QUuid::createUuid().toString() + ".tmp");
+	if (linkOrCopyFile(built, temp, false) == FileLink_Failed)
+	{
+		QLOG_WARN() << "Failed to cache the build" << built;
+		return;
+	}
+	QFile::remove(entry);
+	if (!QFile::rename(temp, entry))
+	{
+		QFile::remove(temp);
+		return;
+	}
+	markUsed(entry);
+	prune();
+}
+
+void JarBuildCache::markUsed(const QString &entry)
+{
+	QSaveFile file(entry + lastUsedSuffix);
+	if (!file.open(QIODevice::WriteOnly))
+		return;
+	file.write(QByteArray::number(QDateTime::currentMSecsSinceEpoch()));
+	file.commit();
+}
+
+qint64 JarBuildCache::lastUsed(const QFileInfo &entry) const
+{
+	QFile file(entry.absoluteFilePath() + lastUsedSuffix);
+	if (file.open(QIODevice::ReadOnly))
+	{
+		bool ok = false;
+		qint64 time = file.readAll().trimmed().toLongLong(&ok);
+		if (ok)
+			return time;
+	}
+	// entries from before the use was recorded
+	return entry.lastModified().toMSecsSinceEpoch();
+}
+
+void JarBuildCache::prune()
+{
+	QDir dir(m_path);
+	auto entries = dir.entryInfoList(QStringList() << "*.jar", QDir::Files);
+	if (entries.size() <= maxEntries)
+		return;
+	QList<QPair<qint64, QString>> byUse;
+	for (auto entry : entries)
+	{
+		byUse.append(qMakePair(lastUsed(entry), entry.absoluteFilePath()));
+	}
+	// most recently used first
+	std::sort(byUse.begin(), byUse.end(), [](const QPair<qint64, QString> &a,
+											 const QPair<qint64, QString> &b)
+	{ return a.first > b.first; });
+	for (int i = maxEntries; i < byUse.size(); i++)
+	{
+		QFile::remove(byUse[i].second);
+		QFile::remove(byUse[i].second + lastUsedSuffix);
+	}
+}
@@ -0,0 +1,71 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QFileInfo>
+#include <QCryptographicHash>
+#include <memory>
+
+/**
+ * Built jars (modded minecraft.jar, stripped version jars), shared between instances.
+ *
+ * A build is keyed by the contents of everything that went into it, in order. Instances
+ * with the same base jar and jar mods get a hard link to the same output instead of
+ * building it again.
+ */
+class JarBuildCache
+{
+public:
+	/// Hashes the inputs of a build into a cache key
+	class Key
+	{
+	public:
+		Key();
+		/// how the inputs are combined (which META-INF to keep, etc.)
+		void addPolicy(const QString &policy);
+		/// a jar, zip or single file, by name and content
+		bool addFile(const QFileInfo &file);
+		/// all the files in a folder, by relative path and content
+		bool addFolder(const QFileInfo &folder);
+		/// the key. Add everything before asking for it.
+		QString result() const;
+
+	private:
+		bool addContent(const QString &path);
+		std::shared_ptr<QCryptographicHash> m_hash;
+	};
+
+	explicit JarBuildCache(QString path);
+
+	/// put the cached build for the key at target. false if there is none.
+	bool fetch(const Key &key, const QString &target);
+
+	/// remember a finished build
+	void store(const Key &key, const QString &built);
+
+private:
+	QString entryPath(const Key &key) const;
+	/// record that the entry was used just now. prune() drops the ones unused the longest.
+	void markUsed(const QString &entry);
+	qint64 lastUsed(const QFileInfo &entry) const;
+	void prune();
+
+private:
+	QString m_path;
+	/// how many builds are kept around
+	static const int maxEntries = 32;
+};
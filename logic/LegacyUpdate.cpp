@@ -27,6 +27,7 @@
 #include "logic/LegacyInstance.h"
 #include "MultiMC.h"
 #include "logic/ModList.h"
+#include "logic/JarBuildCache.h"
 
 #include "logger/QsLog.h"
 #include "logic/net/URLConstants.h"
@@ -421,56 +422,41 @@ bool LegacyUpdate::MergeZipFiles(QuaZip *into, QFileInfo from, QSet<QString> &co
 	setStatus(tr("Installing mods: Adding ") + from.fileName() + " ...");
 
 	QuaZip modZip(from.filePath());
-	modZip.open(QuaZip::mdUnzip);
+	// the instance is not running while its jar is built, so its files hold still
+	modZip.setMemoryMappingEnabled(true);
+	if (!modZip.open(QuaZip::mdUnzip))
+	{
+		QLOG_ERROR() << "Failed to open " << from.fileName();
+		return false;
+	}
 
-	QuaZipFile fileInsideMod(&modZip);
-	QuaZipFile zipOutFile(into);
+	int added = 0, skippedMetainf = 0, skippedContained = 0;
 	for (bool more = modZip.goToFirstFile(); more; more = modZip.goToNextFile())
 	{
 		QString filename = modZip.getCurrentFileName();
 		if (filename.contains("META-INF") && metainf == LegacyUpdate::IgnoreMetainf)
 		{
-			QLOG_INFO() << "Skipping META-INF " << filename << " from " << from.fileName();
+			skippedMetainf++;
 			continue;
 		}
 		if (contained.contains(filename))
 		{
-			QLOG_INFO() << "Skipping already contained file " << filename << " from "
-						<< from.fileName();
+			skippedContained++;
 			continue;
 		}
 		contained.insert(filename);
-		QLOG_INFO() << "Adding file " << filename << " from " << from.fileName();
 
-		if (!fileInsideMod.open(QIODevice::ReadOnly))
-		{
-			QLOG_ERROR() << "Failed to open " << filename << " from " << from.fileName();
-			return false;
-		}
-		/*
-		QuaZipFileInfo old_info;
-		fileInsideMod.getFileInfo(&old_info);
-		*/
-		QuaZipNewInfo info_out(fileInsideMod.getActualFileName());
-		/*
-		info_out.externalAttr = old_info.externalAttr;
-		*/
-		if (!zipOutFile.open(QIODevice::WriteOnly, info_out))
+		// the compressed data goes in as it is, no need to inflate and deflate it again
+		if (!JlCompress::copyRawFile(&modZip, into))
 		{
-			QLOG_ERROR() << "Failed to open " << filename << " in the jar";
-			fileInsideMod.close();
+			QLOG_ERROR() << "Failed to copy " << filename << " from " << from.fileName()
+						 << " into the jar";
 			return false;
 		}
-		if (!JlCompress::copyData(fileInsideMod, zipOutFile))
-		{
-			zipOutFile.close();
-			fileInsideMod.close();
-			QLOG_ERROR() << "Failed to copy data of " << filename << " into the jar";
-			return false;
-		}
-		zipOutFile.close();
-		fileInsideMod.close();
+		added++;
 	}
+	QLOG_INFO() << "Added" << added << "files from" << from.fileName() << "- skipped"
+				<< skippedContained << "already contained and" << skippedMetainf << "META-INF";
 	return true;
 }
 
@@ -528,6 +514,41 @@ void LegacyUpdate::ModTheJar()
 		return;
 	}
 
+	// the same jar may have been built before, by this or another instance
+	setStatus(tr("Installing mods: Checking for a previous build ..."));
+	auto buildCache = MMC->jarBuildCache();
+	JarBuildCache::Key buildKey;
+	bool keyed = buildKey.addFile(baseJar);
+	for (int i = modList->size() - 1; keyed && i >= 0; i--)
+	{
+		auto &mod = modList->operator[](i);
+		if (!mod.enabled())
+			continue;
+		if (mod.type() == Mod::MOD_ZIPFILE)
+		{
+			buildKey.addPolicy("merge");
+			keyed = buildKey.addFile(mod.filename());
+		}
+		else if (mod.type() == Mod::MOD_SINGLEFILE)
+		{
+			buildKey.addPolicy("single");
+			keyed = buildKey.addFile(mod.filename());
+		}
+		else if (mod.type() == Mod::MOD_FOLDER)
+		{
+			buildKey.addPolicy("folder");
+			keyed = buildKey.addFolder(mod.filename());
+		}
+	}
+	// the base jar goes in last, without its META-INF
+	buildKey.addPolicy("base-without-metainf");
+	if (keyed && buildCache->fetch(buildKey, runnableJar.filePath()))
+	{
+		inst->setShouldRebuild(false);
+		emitSucceeded();
+		return;
+	}
+
 	// TaskStep(); // STEP 1
 	setStatus(tr("Installing mods: Opening minecraft.jar ..."));
 
@@ -612,6 +633,8 @@ void LegacyUpdate::ModTheJar()
 		emitFailed("Failed to finalize minecraft.jar!");
 		return;
 	}
+	if (keyed)
+		buildCache->store(buildKey, runnableJar.filePath());
 	inst->setShouldRebuild(false);
 	// inst->UpdateVersion(true);
 	emitSucceeded();
@@ -0,0 +1,345 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "LogClassifier.h"
+#include <QQueue>
+#include <algorithm>
+
+namespace
+{
+/// true if the text at data (length characters) starts with the ASCII needle
+inline bool matchesAt(const QChar *data, int length, const char *needle)
+{
+	for (; *needle; needle++, data++, length--)
+	{
+		if (!length || data->unicode() != uchar(*needle))
+			return false;
+	}
+	return true;
+}
+
+inline bool equals(const QChar *data, int length, const char *needle)
+{
+	return int(qstrlen(needle)) == length && matchesAt(data, length, needle);
+}
+
+/**
+ * log4j lines: "[<timestamp>] [<thread>/<level>]", where the timestamp is digits and colons.
+ * data points at a '['. Returns the level if it is one, and leaves level alone otherwise.
+ */
+bool matchLog4j(const QChar *data, int length, MessageLevel::Enum &level)
+{
+	int i = 1;
+	while (i < length && (data[i].unicode() == ':' ||
+						  (data[i].unicode() >= '0' && data[i].unicode() <= '9')))
+		i++;
+	if (i == 1 || !matchesAt(data + i, length - i, "] ["))
+		return false;
+	i += 3;
+	int start = i;
+	while (i < length && data[i].unicode() != '/')
+		i++;
+	if (i == start || i == length)
+		return false;
+	start = ++i;
+	while (i < length && data[i].unicode() != ']')
+		i++;
+	if (i == start || i == length)
+		return false;
+
+	const QChar *name = data + start;
+	int nameLength = i - start;
+	if (equals(name, nameLength, "INFO"))
+		level = MessageLevel::Message;
+	else if (equals(name, nameLength, "WARN"))
+		level = MessageLevel::Warning;
+	else if (equals(name, nameLength, "ERROR"))
+		level = MessageLevel::Error;
+	else if (equals(name, nameLength, "FATAL"))
+		level = MessageLevel::Fatal;
+	else if (equals(name, nameLength, "TRACE") || equals(name, nameLength, "DEBUG"))
+		level = MessageLevel::Debug;
+	return true;
+}
+
+/// the tags of old style forge logs, in the order they override each other
+enum OldStyleTag
+{
+	OldMessage = 0x1,
+	OldError = 0x2,
+	OldWarning = 0x4,
+	OldDebug = 0x8
+};
+
+const struct
+{
+	const char *tag;
+	OldStyleTag flag;
+} oldStyleTags[] = {{"[INFO]", OldMessage},	 {"[CONFIG]", OldMessage}, {"[FINE]", OldMessage},
+					{"[FINER]", OldMessage},  {"[FINEST]", OldMessage}, {"[SEVERE]", OldError},
+					{"[STDERR]", OldError},	  {"[WARNING]", OldWarning}, {"[DEBUG]", OldDebug}};
+
+/// data points at a '['
+int matchOldStyle(const QChar *data, int length)
+{
+	int flags = 0;
+	for (auto &tag : oldStyleTags)
+	{
+		if (matchesAt(data, length, tag.tag))
+			flags |= tag.flag;
+	}
+	return flags;
+}
+}
+
+LogClassifier::LogClassifier()
+{
+	build();
+}
+
+void LogClassifier::addSecret(const QString &secret, const QString &replacement)
+{
+	// an empty secret would match between all the characters
+	if (secret.isEmpty())
+		return;
+	m_secrets.append({secret, replacement});
+	build();
+}
+
+void LogClassifier::clearSecrets()
+{
+	m_secrets.clear();
+	build();
+}
+
+void LogClassifier::build()
+{
+	m_nodes.resize(1);
+	m_nodes[0] = Node();
+	m_edges.clear();
+	QVector<QVector<QPair<ushort, int>>> children(1);
+
+	for (int i = 0; i < m_secrets.size(); i++)
+	{
+		int state = 0;
+		for (QChar c : m_secrets[i].text)
+		{
+			quint64 key = (quint64(state) << 16) | c.unicode();
+			auto edge = m_edges.constFind(key);
+			if (edge != m_edges.constEnd())
+			{
+				state = edge.value();
+				continue;
+			}
+			Node node;
+			node.depth = m_nodes[state].depth + 1;
+			m_nodes.append(node);
+			children.append(QVector<QPair<ushort, int>>());
+			int next = m_nodes.size() - 1;
+			m_edges.insert(key, next);
+			children[state].append(qMakePair(c.unicode(), next));
+			state = next;
+		}
+		// the same secret twice is replaced by the first replacement
+		if (m_nodes[state].secret == -1)
+			m_nodes[state].secret = i;
+	}
+
+	// fail links, breadth first so the ones of the shorter prefixes are already there
+	QQueue<int> queue;
+	for (auto &child : children[0])
+		queue.enqueue(child.second);
+	while (!queue.isEmpty())
+	{
+		int parent = queue.dequeue();
+		for (auto &child : children[parent])
+		{
+			int fail = step(m_nodes[parent].fail, child.first);
+			Node &node = m_nodes[child.second];
+			node.fail = fail;
+			node.output = m_nodes[fail].secret != -1 ? fail : m_nodes[fail].output;
+			queue.enqueue(child.second);
+		}
+	}
+}
+
+int LogClassifier::step(int state, ushort c) const
+{
+	forever
+	{
+		auto edge = m_edges.constFind((quint64(state) << 16) | c);
+		if (edge != m_edges.constEnd())
+			return edge.value();
+		if (state == 0)
+			return 0;
+		state = m_nodes[state].fail;
+	}
+}
+
+MessageLevel::Enum LogClassifier::classify(QString &line, MessageLevel::Enum defaultLevel,
+										   bool guess, bool censor) const
+{
+	// Level prefix
+	if (line.startsWith(QLatin1String("!![")))
+	{
+		int endmark = line.indexOf(QLatin1String("]!"));
+		if (endmark != -1)
+		{
+			auto level = levelFromName(line.midRef(3, endmark - 3));
+			line.remove(0, endmark + 2);
+			return scan(line, level, false, censor);
+		}
+	}
+	return scan(line, defaultLevel, guess, censor);
+}
+
+QString LogClassifier::censor(QString line) const
+{
+	scan(line, MessageLevel::Message, false, true);
+	return line;
+}
+
+MessageLevel::Enum LogClassifier::scan(QString &line, MessageLevel::Enum level, bool guess,
+									   bool censor) const
+{
+	censor = censor && !m_secrets.isEmpty();
+	if (!guess && !censor)
+		return level;
+
+	struct Match
+	{
+		int start;
+		int secret;
+	};
+	QVector<Match> matches;
+
+	bool log4j = false;
+	MessageLevel::Enum log4jLevel = level;
+	int oldStyle = 0;
+	bool overwriting = false;
+	bool exception = false;
+
+	const QChar *data = line.constData();
+	const int length = line.size();
+	int state = 0;
+	for (int i = 0; i < length; i++)
+	{
+		const ushort c = data[i].unicode();
+		if (censor)
+		{
+			state = step(state, c);
+			int node = m_nodes[state].secret != -1 ? state : m_nodes[state].output;
+			for (; node != -1; node = m_nodes[node].output)
+			{
+				matches.append({i + 1 - m_nodes[node].depth, m_nodes[node].secret});
+			}
+		}
+		if (!guess)
+			continue;
+		switch (c)
+		{
+		case '[':
+			if (!log4j)
+				log4j = matchLog4j(data + i, length - i, log4jLevel);
+			oldStyle |= matchOldStyle(data + i, length - i);
+			break;
+		case 'a':
+			// "\s+at ", a stack trace
+			if (i > 0 && data[i - 1].isSpace() && matchesAt(data + i, length - i, "at "))
+				exception = true;
+			break;
+		case 'E':
+			if (matchesAt(data + i, length - i, "Exception in thread"))
+				exception = true;
+			break;
+		case 'o':
+			if (matchesAt(data + i, length - i, "overwriting existing"))
+				overwriting = true;
+			break;
+		}
+	}
+
+	if (!matches.isEmpty())
+	{
+		// leftmost first, and the longest of the ones starting at the same place
+		std::sort(matches.begin(), matches.end(), [this](const Match &a, const Match &b)
+		{
+			if (a.start != b.start)
+				return a.start < b.start;
+			return m_secrets[a.secret].text.size() > m_secrets[b.secret].text.size();
+		});
+		QString censored;
+		censored.reserve(length);
+		int done = 0;
+		for (auto &match : matches)
+		{
+			// overlaps one that was already replaced
+			if (match.start < done)
+				continue;
+			censored.append(line.midRef(done, match.start - done));
+			censored.append(m_secrets[match.secret].replacement);
+			done = match.start + m_secrets[match.secret].text.size();
+		}
+		censored.append(line.midRef(done));
+		line = censored;
+	}
+
+	if (!guess)
+		return level;
+	if (log4j)
+	{
+		// New style logs from log4j
+		level = log4jLevel;
+	}
+	else
+	{
+		// Old style forge logs
+		if (oldStyle & OldMessage)
+			level = MessageLevel::Message;
+		if (oldStyle & OldError)
+			level = MessageLevel::Error;
+		if (oldStyle & OldWarning)
+			level = MessageLevel::Warning;
+		if (oldStyle & OldDebug)
+			level = MessageLevel::Debug;
+	}
+	if (overwriting)
+		return MessageLevel::Fatal;
+	if (exception)
+		return MessageLevel::Error;
+	return level;
+}
+
+MessageLevel::Enum LogClassifier::levelFromName(const QStringRef &levelName)
+{
+	if (levelName == QLatin1String("MultiMC"))
+		return MessageLevel::MultiMC;
+	else if (levelName == QLatin1String("Debug"))
+		return MessageLevel::Debug;
+	else if (levelName == QLatin1String("Info"))
+		return MessageLevel::Info;
+	else if (levelName == QLatin1String("Message"))
+		return MessageLevel::Message;
+	else if (levelName == QLatin1String("Warning"))
+		return MessageLevel::Warning;
+	else if (levelName == QLatin1String("Error"))
+		return MessageLevel::Error;
+	else if (levelName == QLatin1String("Fatal"))
+		return MessageLevel::Fatal;
+	// Skip PrePost, it's not exposed to !![]!
+	else
+		return MessageLevel::Message;
+}
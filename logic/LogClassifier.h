@@ -0,0 +1,87 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+
+#include "MessageLevel.h"
+
+/**
+ * Finds the level of game output lines and censors the secrets in them.
+ *
+ * The patterns are compiled once. The level and all the secrets are found in a single
+ * pass over the line, which only allocates when there is something to censor.
+ * The secrets are matched together, with an Aho-Corasick automaton.
+ *
+ * Classifying doesn't change the classifier, so it can be shared between threads
+ * as long as the secrets aren't changed at the same time.
+ */
+class LogClassifier
+{
+public:
+	LogClassifier();
+
+	/// replace all occurences of the secret with the replacement when censoring
+	void addSecret(const QString &secret, const QString &replacement);
+
+	/// forget all the secrets
+	void clearSecrets();
+
+	/**
+	 * Find the level of the line and censor it.
+	 * A "!![Level]!" prefix sets the level explicitly and is removed from the line.
+	 * Otherwise the level is guessed from the content, if guess is set,
+	 * or defaultLevel is used.
+	 */
+	MessageLevel::Enum classify(QString &line, MessageLevel::Enum defaultLevel, bool guess = true,
+								bool censor = true) const;
+
+	/// the line with the secrets replaced
+	QString censor(QString line) const;
+
+	/// level for the name used in the "!![Level]!" prefix
+	static MessageLevel::Enum levelFromName(const QStringRef &levelName);
+
+private:
+	struct Node
+	{
+		/// longest proper suffix that is also in the trie
+		int fail = 0;
+		/// closest node on the fail chain that ends a secret, or -1
+		int output = -1;
+		/// the secret ending here, or -1
+		int secret = -1;
+		int depth = 0;
+	};
+	struct Secret
+	{
+		QString text;
+		QString replacement;
+	};
+
+	void build();
+	int step(int state, ushort c) const;
+	MessageLevel::Enum scan(QString &line, MessageLevel::Enum defaultLevel, bool guess,
+							bool censor) const;
+
+	QVector<Secret> m_secrets;
+	QVector<Node> m_nodes;
+	/// (node << 16 | character) -> node
+	QHash<quint64, int> m_edges;
+};
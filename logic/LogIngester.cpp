@@ -0,0 +1,150 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "LogIngester.h"
+#include <QtConcurrentRun>
+#include <QTextCodec>
+
+LogIngester::LogIngester(QObject *parent) : QObject(parent)
+{
+	for (auto &channel : m_channels)
+	{
+		channel.decoder.reset(QTextCodec::codecForLocale()->makeDecoder());
+	}
+	// about once per frame
+	m_deliveryTimer.setInterval(16);
+	connect(&m_deliveryTimer, SIGNAL(timeout()), SLOT(deliver()));
+}
+
+LogIngester::~LogIngester()
+{
+	// the drain uses the members
+	m_drain.waitForFinished();
+}
+
+void LogIngester::setClassifier(const LogClassifier &classifier)
+{
+	m_drain.waitForFinished();
+	m_classifier = classifier;
+}
+
+void LogIngester::feed(Channel channel, const QByteArray &data, MessageLevel::Enum defaultLevel,
+					   bool guess, bool censor)
+{
+	if (data.isEmpty())
+		return;
+	{
+		QMutexLocker locker(&m_lock);
+		m_input.enqueue({channel, data, defaultLevel, guess, censor});
+		if (!m_draining)
+		{
+			m_draining = true;
+			m_drain = QtConcurrent::run(this, &LogIngester::drain);
+		}
+	}
+	if (!m_deliveryTimer.isActive())
+		m_deliveryTimer.start();
+}
+
+void LogIngester::drain()
+{
+	forever
+	{
+		QQueue<Chunk> input;
+		{
+			QMutexLocker locker(&m_lock);
+			if (m_input.isEmpty())
+			{
+				m_draining = false;
+				return;
+			}
+			input.swap(m_input);
+		}
+
+		QList<LogLine> out;
+		for (auto &chunk : input)
+		{
+			auto &state = m_channels[chunk.channel];
+			state.level = chunk.level;
+			state.guess = chunk.guess;
+			state.censor = chunk.censor;
+
+			QString text = state.leftover + state.decoder->toUnicode(chunk.data);
+			text.remove('\r');
+			int start = 0;
+			int end;
+			while ((end = text.indexOf('\n', start)) != -1)
+			{
+				classify(out, state, text.mid(start, end - start));
+				start = end + 1;
+			}
+			state.leftover = text.mid(start);
+		}
+
+		QMutexLocker locker(&m_lock);
+		m_output.append(out);
+	}
+}
+
+void LogIngester::classify(QList<LogLine> &out, ChannelState &state, QString line)
+{
+	auto level = m_classifier.classify(line, state.level, state.guess, state.censor);
+	out.append({line, level});
+}
+
+void LogIngester::flush()
+{
+	// with the drain done, nothing else can touch the queue or the channels
+	m_drain.waitForFinished();
+	{
+		QMutexLocker locker(&m_lock);
+		m_draining = true;
+	}
+	drain();
+
+	QList<LogLine> rest;
+	for (auto &state : m_channels)
+	{
+		if (state.leftover.isEmpty())
+			continue;
+		classify(rest, state, state.leftover);
+		state.leftover.clear();
+	}
+	{
+		QMutexLocker locker(&m_lock);
+		m_output.append(rest);
+	}
+	deliver();
+}
+
+void LogIngester::deliver()
+{
+	QList<LogLine> batch;
+	bool draining;
+	{
+		QMutexLocker locker(&m_lock);
+		batch.swap(m_output);
+		draining = m_draining;
+	}
+	if (batch.isEmpty())
+	{
+		// nothing is coming, wake up again with the next feed
+		if (!draining)
+			m_deliveryTimer.stop();
+		return;
+	}
+	emit lines(batch);
+}
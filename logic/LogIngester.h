@@ -0,0 +1,118 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QQueue>
+#include <QMutex>
+#include <QTimer>
+#include <QFuture>
+#include <QTextDecoder>
+#include <memory>
+
+#include "MessageLevel.h"
+#include "LogClassifier.h"
+
+/// a line of output and its level
+struct LogLine
+{
+	QString text;
+	MessageLevel::Enum level;
+};
+
+/**
+ * Turns the raw output of a process into classified lines.
+ *
+ * The GUI thread only hands over the bytes it read from the pipes. Decoding, splitting
+ * and classifying happen on the global thread pool. The finished lines are collected
+ * and delivered in batches, at most once per frame, so a flood of output costs the GUI
+ * one update per frame instead of one per line.
+ */
+class LogIngester : public QObject
+{
+	Q_OBJECT
+public:
+	enum Channel
+	{
+		StdOut,
+		StdErr
+	};
+
+	explicit LogIngester(QObject *parent = 0);
+	virtual ~LogIngester();
+
+	/// the classifier used for all lines fed after this. Waits for the lines being worked on.
+	void setClassifier(const LogClassifier &classifier);
+
+	/**
+	 * Queue output read from a pipe. Lines that end in it are classified with the given
+	 * parameters, the rest waits for more data on the same channel.
+	 */
+	void feed(Channel channel, const QByteArray &data, MessageLevel::Enum defaultLevel,
+			  bool guess = true, bool censor = true);
+
+	/**
+	 * Process everything that was fed and deliver it right away, including the unfinished
+	 * lines. Use before logging anything that has to come after the output.
+	 */
+	void flush();
+
+signals:
+	void lines(QList<LogLine> lines);
+
+private
+slots:
+	void deliver();
+
+private:
+	struct Chunk
+	{
+		Channel channel;
+		QByteArray data;
+		MessageLevel::Enum level;
+		bool guess;
+		bool censor;
+	};
+	/// what a channel needs between chunks, only used by the drain
+	struct ChannelState
+	{
+		std::unique_ptr<QTextDecoder> decoder;
+		QString leftover;
+		MessageLevel::Enum level = MessageLevel::Message;
+		bool guess = true;
+		bool censor = true;
+	};
+
+	/// process the queued chunks until there are none left. Runs on the thread pool.
+	void drain();
+	void classify(QList<LogLine> &out, ChannelState &state, QString line);
+
+private:
+	QMutex m_lock;
+	/// guarded by m_lock
+	QQueue<Chunk> m_input;
+	/// guarded by m_lock
+	QList<LogLine> m_output;
+	/// guarded by m_lock
+	bool m_draining = false;
+
+	QFuture<void> m_drain;
+	ChannelState m_channels[2];
+	LogClassifier m_classifier;
+	QTimer m_deliveryTimer;
+};
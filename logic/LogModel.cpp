@@ -0,0 +1,253 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "LogModel.h"
+#include <QColor>
+#include <QDateTime>
+#include <QFontMetrics>
+#include <QStringMatcher>
+#include "logger/QsLog.h"
+
+LogModel::LogModel(int capacity, QObject *parent)
+	: QAbstractListModel(parent), m_capacity(qMax(capacity, 1))
+{
+}
+
+int LogModel::rowCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : m_count;
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid() || index.row() >= m_count)
+		return QVariant();
+
+	const Entry &e = entry(index.row());
+	switch (role)
+	{
+	case Qt::DisplayRole:
+		return e.text;
+	case Qt::ToolTipRole:
+		return QDateTime::fromMSecsSinceEpoch(e.time).toString(Qt::DefaultLocaleLongDate);
+	case LevelRole:
+		return e.level;
+	case TimeRole:
+		return e.time;
+	case Qt::ForegroundRole:
+		switch (e.level)
+		{
+		case MessageLevel::MultiMC:
+			return QColor("blue");
+		case MessageLevel::Debug:
+			return QColor("green");
+		case MessageLevel::Warning:
+			return QColor("orange");
+		case MessageLevel::Error:
+		case MessageLevel::Fatal:
+			return QColor("red");
+		case MessageLevel::PrePost:
+			return QColor("grey");
+		default:
+			return QVariant();
+		}
+	case Qt::BackgroundRole:
+		if (e.level == MessageLevel::Fatal)
+			return QColor("black");
+		return QVariant();
+	case Qt::SizeHintRole:
+		if (m_size_hint.isValid())
+			return m_size_hint;
+		return QVariant();
+	default:
+		return QVariant();
+	}
+}
+
+void LogModel::setFont(const QFont &font)
+{
+	m_font = font;
+	m_widest_length = 0;
+	m_size_hint = QSize();
+	int widest = -1;
+	for (int row = 0; row < m_count; row++)
+	{
+		if (text(row).size() >= m_widest_length)
+		{
+			m_widest_length = text(row).size();
+			widest = row;
+		}
+	}
+	if (widest < 0)
+		return;
+	// measured on the longest line, exact for the usual monospace console fonts
+	QFontMetrics metrics(m_font);
+	m_size_hint = QSize(metrics.width(text(widest)) + 8, metrics.lineSpacing());
+	emit dataChanged(index(0), index(m_count - 1));
+}
+
+void LogModel::spill(const QList<LogLine> &lines)
+{
+	if (lines.isEmpty())
+		return;
+
+	if (m_spill.isOpen())
+	{
+		QByteArray data;
+		for (auto &line : lines)
+		{
+			data += line.text.toUtf8();
+			data += '\n';
+		}
+		if (m_spill.write(data) != data.size())
+		{
+			QLOG_ERROR() << "Can't write the console log to" << m_spill.fileName()
+						 << m_spill.errorString();
+			m_spill.close();
+		}
+	}
+}
+
+void LogModel::append(const QList<LogLine> &lines)
+{
+	if (lines.isEmpty())
+		return;
+
+	qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+	// of a huge batch, only the end fits
+	int incoming = qMin(lines.size(), m_capacity);
+	int skip = lines.size() - incoming;
+
+	int overflow = m_count + incoming - m_capacity;
+	if (overflow > 0)
+	{
+		beginRemoveRows(QModelIndex(), 0, overflow - 1);
+		for (int i = 0; i < overflow; i++)
+		{
+			// let go of the text now, the slot may not be reused for a while
+			m_entries[(m_first + i) % m_capacity] = Entry();
+		}
+		m_first = (m_first + overflow) % m_capacity;
+		m_count -= overflow;
+		endRemoveRows();
+	}
+
+	beginInsertRows(QModelIndex(), m_count, m_count + incoming - 1);
+	for (int i = skip; i < lines.size(); i++)
+	{
+		Entry e;
+		e.text = lines[i].text;
+		if (e.text.size() > m_widest_length)
+		{
+			// rows with uniform sizes are all as wide as this says
+			m_widest_length = e.text.size();
+			QFontMetrics metrics(m_font);
+			m_size_hint = QSize(metrics.width(e.text) + 8, metrics.lineSpacing());
+		}
+		e.level = lines[i].level;
+		e.time = now;
+		// the buffer fills up front to back before it ever wraps
+		int position = (m_first + m_count) % m_capacity;
+		if (position == m_entries.size())
+			m_entries.append(e);
+		else
+			m_entries[position] = e;
+		m_count++;
+	}
+	endInsertRows();
+}
+
+void LogModel::clear()
+{
+	beginResetModel();
+	m_entries.clear();
+	m_first = 0;
+	m_count = 0;
+	m_widest_length = 0;
+	m_size_hint = QSize();
+	endResetModel();
+}
+
+bool LogModel::setSpillFile(const QString &path)
+{
+	m_spill.close();
+	m_spill.setFileName(path);
+	if (!m_spill.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		QLOG_ERROR() << "Can't open" << path << "for the console log:" << m_spill.errorString();
+		return false;
+	}
+	return true;
+}
+
+QString LogModel::fullText()
+{
+	if (!m_spill.isOpen())
+		return bufferedText();
+	m_spill.flush();
+	QFile file(m_spill.fileName());
+	if (!file.open(QIODevice::ReadOnly))
+		return bufferedText();
+	return QString::fromUtf8(file.readAll());
+}
+
+QString LogModel::bufferedText() const
+{
+	QString out;
+	for (int row = 0; row < m_count; row++)
+	{
+		out += text(row);
+		out += '\n';
+	}
+	return out;
+}
+
+LogFilterModel::LogFilterModel(LogModel *source, QObject *parent)
+	: QSortFilterProxyModel(parent), m_source(source)
+{
+	setSourceModel(source);
+	setDynamicSortFilter(true);
+}
+
+void LogFilterModel::setMinimumLevel(MessageLevel::Enum level)
+{
+	m_minimumLevel = level;
+	invalidateFilter();
+}
+
+bool LogFilterModel::filterAcceptsRow(int source_row, const QModelIndex &) const
+{
+	auto level = m_source->level(source_row);
+	return level == MessageLevel::MultiMC || level == MessageLevel::PrePost ||
+		   level >= m_minimumLevel;
+}
+
+int LogFilterModel::find(const QString &text, int from, bool backward) const
+{
+	if (text.isEmpty())
+		return -1;
+	// the needle is prepared once, the buffer is bounded so this is too
+	QStringMatcher matcher(text, Qt::CaseInsensitive);
+	int step = backward ? -1 : 1;
+	for (int row = from + step; row >= 0 && row < rowCount(); row += step)
+	{
+		int source_row = mapToSource(index(row, 0)).row();
+		if (matcher.indexIn(m_source->text(source_row)) != -1)
+			return row;
+	}
+	return -1;
+}
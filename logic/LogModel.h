@@ -0,0 +1,140 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QSortFilterProxyModel>
+#include <QVector>
+#include <QFile>
+#include <QFont>
+#include <QSize>
+
+#include "LogIngester.h"
+
+/**
+ * The console log: a ring buffer of the last lines, with their level and time.
+ *
+ * Only the newest capacity() lines are kept in memory, the oldest ones are dropped
+ * from the front as new ones come in. Every line is also written to the spill file,
+ * if there is one, so the whole log is still available for copying and uploading.
+ */
+class LogModel : public QAbstractListModel
+{
+	Q_OBJECT
+public:
+	enum Roles
+	{
+		LevelRole = Qt::UserRole,
+		TimeRole
+	};
+
+	explicit LogModel(int capacity, QObject *parent = 0);
+
+	virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+	virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+	/// write lines to the spill file
+	void spill(const QList<LogLine> &lines);
+
+	/// add lines at the end, dropping the oldest ones past the capacity. Doesn't spill them.
+	void append(const QList<LogLine> &lines);
+
+	/**
+	 * The font the lines are shown in. Every row reports the size of the widest line seen
+	 * so far as its size hint, so a view with uniform item sizes can scroll to all of it.
+	 */
+	void setFont(const QFont &font);
+
+	/// drop everything that is in memory. The spill file keeps it.
+	void clear();
+
+	/// the most lines kept in memory
+	int capacity() const
+	{
+		return m_capacity;
+	}
+
+	const QString &text(int row) const
+	{
+		return entry(row).text;
+	}
+	MessageLevel::Enum level(int row) const
+	{
+		return entry(row).level;
+	}
+
+	/// start writing all the lines to the given file, replacing it. false if it can't be opened.
+	bool setSpillFile(const QString &path);
+
+	/// the whole log, from the spill file if there is one or from memory otherwise
+	QString fullText();
+
+	/// the lines that are in memory
+	QString bufferedText() const;
+
+private:
+	struct Entry
+	{
+		QString text;
+		MessageLevel::Enum level = MessageLevel::Message;
+		qint64 time = 0;
+	};
+	const Entry &entry(int row) const
+	{
+		return m_entries[(m_first + row) % m_capacity];
+	}
+
+private:
+	/// grows up to m_capacity, then wraps around
+	QVector<Entry> m_entries;
+	int m_capacity;
+	/// where row 0 is in m_entries
+	int m_first = 0;
+	int m_count = 0;
+	QFile m_spill;
+	QFont m_font;
+	/// length of the longest line seen, and the size hint that goes with it
+	int m_widest_length = 0;
+	QSize m_size_hint;
+};
+
+/// shows only the lines of a LogModel that are at least at a given level
+class LogFilterModel : public QSortFilterProxyModel
+{
+	Q_OBJECT
+public:
+	explicit LogFilterModel(LogModel *source, QObject *parent = 0);
+
+	/**
+	 * Hide everything below the level. Our own messages (MultiMC and PrePost)
+	 * are always shown.
+	 */
+	void setMinimumLevel(MessageLevel::Enum level);
+
+	/**
+	 * The next (or previous) shown row containing the text, starting after (before) from.
+	 * Case insensitive. Returns -1 if there is none.
+	 */
+	int find(const QString &text, int from, bool backward) const;
+
+protected:
+	virtual bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const;
+
+private:
+	LogModel *m_source;
+	MessageLevel::Enum m_minimumLevel = MessageLevel::Debug;
+};
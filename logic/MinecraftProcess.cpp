@@ -23,7 +23,6 @@
 #include <QFile>
 #include <QDir>
 #include <QProcessEnvironment>
-#include <QRegularExpression>
 #include <QStandardPaths>
 
 #include "BaseInstance.h"
@@ -98,6 +97,7 @@ MinecraftProcess::MinecraftProcess(InstancePtr inst) : m_instance(inst)
 	// std channels
 	connect(this, SIGNAL(readyReadStandardError()), SLOT(on_stdErr()));
 	connect(this, SIGNAL(readyReadStandardOutput()), SLOT(on_stdOut()));
+	connect(&m_ingester, SIGNAL(lines(QList<LogLine>)), SIGNAL(logLines(QList<LogLine>)));
 
 	// Log prepost launch command output (can be disabled.)
 	if (m_instance->settings().get("LogPrePostOutput").toBool())
@@ -119,181 +119,59 @@ void MinecraftProcess::setWorkdir(QString path)
 	m_prepostlaunchprocess.setWorkingDirectory(mcDir.absolutePath());
 }
 
-QString MinecraftProcess::censorPrivateInfo(QString in)
+void MinecraftProcess::setLogin(AuthSessionPtr session)
 {
+	m_session = session;
+	m_classifier.clearSecrets();
 	if (!m_session)
-		return in;
+	{
+		m_ingester.setClassifier(m_classifier);
+		return;
+	}
 
 	if (m_session->session != "-")
-		in.replace(m_session->session, "<SESSION ID>");
-	in.replace(m_session->access_token, "<ACCESS TOKEN>");
-	in.replace(m_session->client_token, "<CLIENT TOKEN>");
-	in.replace(m_session->uuid, "<PROFILE ID>");
-	in.replace(m_session->player_name, "<PROFILE NAME>");
+		m_classifier.addSecret(m_session->session, "<SESSION ID>");
+	m_classifier.addSecret(m_session->access_token, "<ACCESS TOKEN>");
+	m_classifier.addSecret(m_session->client_token, "<CLIENT TOKEN>");
+	m_classifier.addSecret(m_session->uuid, "<PROFILE ID>");
+	m_classifier.addSecret(m_session->player_name, "<PROFILE NAME>");
 
 	auto i = m_session->u.properties.begin();
 	while (i != m_session->u.properties.end())
 	{
-		in.replace(i.value(), "<" + i.key().toUpper() + ">");
+		m_classifier.addSecret(i.value(), "<" + i.key().toUpper() + ">");
 		++i;
 	}
-
-	return in;
-}
-
-// console window
-MessageLevel::Enum MinecraftProcess::guessLevel(const QString &line, MessageLevel::Enum level)
-{
-	QRegularExpression re("\\[(?<timestamp>[0-9:]+)\\] \\[[^/]+/(?<level>[^\\]]+)\\]");
-	auto match = re.match(line);
-	if(match.hasMatch())
-	{
-		// New style logs from log4j
-		QString timestamp = match.captured("timestamp");
-		QString levelStr = match.captured("level");
-		if(levelStr == "INFO")
-			level = MessageLevel::Message;
-		if(levelStr == "WARN")
-			level = MessageLevel::Warning;
-		if(levelStr == "ERROR")
-			level = MessageLevel::Error;
-		if(levelStr == "FATAL")
-			level = MessageLevel::Fatal;
-		if(levelStr == "TRACE" || levelStr == "DEBUG")
-			level = MessageLevel::Debug;
-	}
-	else
-	{
-		// Old style forge logs
-		if (line.contains("[INFO]") || line.contains("[CONFIG]") || line.contains("[FINE]") ||
-			line.contains("[FINER]") || line.contains("[FINEST]"))
-			level = MessageLevel::Message;
-		if (line.contains("[SEVERE]") || line.contains("[STDERR]"))
-			level = MessageLevel::Error;
-		if (line.contains("[WARNING]"))
-			level = MessageLevel::Warning;
-		if (line.contains("[DEBUG]"))
-			level = MessageLevel::Debug;
-	}
-	if (line.contains("overwriting existing"))
-		return MessageLevel::Fatal;
-	if (line.contains("Exception in thread") || line.contains(QRegularExpression("\\s+at ")))
-		return MessageLevel::Error;
-	return level;
-}
-
-MessageLevel::Enum MinecraftProcess::getLevel(const QString &levelName)
-{
-	if (levelName == "MultiMC")
-		return MessageLevel::MultiMC;
-	else if (levelName == "Debug")
-		return MessageLevel::Debug;
-	else if (levelName == "Info")
-		return MessageLevel::Info;
-	else if (levelName == "Message")
-		return MessageLevel::Message;
-	else if (levelName == "Warning")
-		return MessageLevel::Warning;
-	else if (levelName == "Error")
-		return MessageLevel::Error;
-	else if (levelName == "Fatal")
-		return MessageLevel::Fatal;
-	// Skip PrePost, it's not exposed to !![]!
-	else
-		return MessageLevel::Message;
-}
-
-void MinecraftProcess::logOutput(const QStringList &lines, MessageLevel::Enum defaultLevel,
-								 bool guessLevel, bool censor)
-{
-	for (int i = 0; i < lines.size(); ++i)
-		logOutput(lines[i], defaultLevel, guessLevel, censor);
-}
-
-void MinecraftProcess::logOutput(QString line, MessageLevel::Enum defaultLevel, bool guessLevel,
-								 bool censor)
-{
-	MessageLevel::Enum level = defaultLevel;
-
-	// Level prefix
-	int endmark = line.indexOf("]!");
-	if (line.startsWith("!![") && endmark != -1)
-	{
-		level = getLevel(line.left(endmark).mid(3));
-		line = line.mid(endmark + 2);
-	}
-	// Guess level
-	else if (guessLevel)
-		level = this->guessLevel(line, defaultLevel);
-
-	if (censor)
-		line = censorPrivateInfo(line);
-
-	emit log(line, level);
+	m_ingester.setClassifier(m_classifier);
 }
 
 void MinecraftProcess::on_stdErr()
 {
-	QByteArray data = readAllStandardError();
-	QString str = m_err_leftover + QString::fromLocal8Bit(data);
-
-	str.remove('\r');
-	QStringList lines = str.split("\n");
-	m_err_leftover = lines.takeLast();
-
-	logOutput(lines, MessageLevel::Error);
+	m_ingester.feed(LogIngester::StdErr, readAllStandardError(), MessageLevel::Error);
 }
 
 void MinecraftProcess::on_stdOut()
 {
-	QByteArray data = readAllStandardOutput();
-	QString str = m_out_leftover + QString::fromLocal8Bit(data);
-
-	str.remove('\r');
-	QStringList lines = str.split("\n");
-	m_out_leftover = lines.takeLast();
-
-	logOutput(lines);
+	m_ingester.feed(LogIngester::StdOut, readAllStandardOutput(), MessageLevel::Message);
 }
 
 void MinecraftProcess::on_prepost_stdErr()
 {
-	QByteArray data = m_prepostlaunchprocess.readAllStandardError();
-	QString str = m_err_leftover + QString::fromLocal8Bit(data);
-
-	str.remove('\r');
-	QStringList lines = str.split("\n");
-	m_err_leftover = lines.takeLast();
-
-	logOutput(lines, MessageLevel::PrePost, false, false);
+	m_ingester.feed(LogIngester::StdErr, m_prepostlaunchprocess.readAllStandardError(),
+					MessageLevel::PrePost, false, false);
 }
 
 void MinecraftProcess::on_prepost_stdOut()
 {
-	QByteArray data = m_prepostlaunchprocess.readAllStandardOutput();
-	QString str = m_out_leftover + QString::fromLocal8Bit(data);
-
-	str.remove('\r');
-	QStringList lines = str.split("\n");
-	m_out_leftover = lines.takeLast();
-
-	logOutput(lines, MessageLevel::PrePost, false, false);
+	m_ingester.feed(LogIngester::StdOut, m_prepostlaunchprocess.readAllStandardOutput(),
+					MessageLevel::PrePost, false, false);
 }
 
 // exit handler
 void MinecraftProcess::finish(int code, ExitStatus status)
 {
 	// Flush console window
-	if (!m_err_leftover.isEmpty())
-	{
-		logOutput(m_err_leftover, MessageLevel::Error);
-		m_err_leftover.clear();
-	}
-	if (!m_out_leftover.isEmpty())
-	{
-		logOutput(m_out_leftover);
-		m_out_leftover.clear();
-	}
+	m_ingester.flush();
 
 	if (!killed)
 	{
@@ -352,16 +230,7 @@ bool MinecraftProcess::preLaunch()
 			return false;
 		}
 		// Flush console window
-		if (!m_err_leftover.isEmpty())
-		{
-			logOutput(m_err_leftover, MessageLevel::PrePost);
-			m_err_leftover.clear();
-		}
-		if (!m_out_leftover.isEmpty())
-		{
-			logOutput(m_out_leftover, MessageLevel::PrePost);
-			m_out_leftover.clear();
-		}
+		m_ingester.flush();
 		// Process return values
 		if (m_prepostlaunchprocess.exitStatus() != NormalExit)
 		{
@@ -395,16 +264,7 @@ bool MinecraftProcess::postLaunch()
 			return false;
 		}
 		// Flush console window
-		if (!m_err_leftover.isEmpty())
-		{
-			logOutput(m_err_leftover, MessageLevel::PrePost);
-			m_err_leftover.clear();
-		}
-		if (!m_out_leftover.isEmpty())
-		{
-			logOutput(m_out_leftover, MessageLevel::PrePost);
-			m_out_leftover.clear();
-		}
+		m_ingester.flush();
 		if (m_prepostlaunchprocess.exitStatus() != NormalExit)
 		{
 			emit log(tr("Post-Launch command failed with code %1.\n\n")
@@ -520,7 +380,7 @@ void MinecraftProcess::arm()
 	QString JavaPath = m_instance->settings().get("JavaPath").toString();
 	emit log("Java path is:\n" + JavaPath + "\n\n");
 	QString allArgs = args.join(", ");
-	emit log("Java Arguments:\n[" + censorPrivateInfo(allArgs) + "]\n\n");
+	emit log("Java Arguments:\n[" + m_classifier.censor(allArgs) + "]\n\n");
 
 	auto realJavaPath = QStandardPaths::findExecutable(JavaPath);
 	if (realJavaPath.isEmpty())
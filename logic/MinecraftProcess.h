@@ -20,25 +20,9 @@
 #include <QProcess>
 #include <QString>
 #include "BaseInstance.h"
-
-/**
- * @brief the MessageLevel Enum
- * defines what level a message is
- */
-namespace MessageLevel
-{
-enum Enum
-{
-	MultiMC, /**< MultiMC Messages */
-	Debug,   /**< Debug Messages */
-	Info,    /**< Info Messages */
-	Message, /**< Standard Messages */
-	Warning, /**< Warnings */
-	Error,   /**< Errors */
-	Fatal,   /**< Fatal Errors */
-	PrePost, /**< Pre/Post Launch command output */
-};
-}
+#include "MessageLevel.h"
+#include "LogClassifier.h"
+#include "LogIngester.h"
 
 /**
  * @file data/minecraftprocess.h
@@ -93,10 +77,7 @@ public:
 
 	void killMinecraft();
 
-	inline void setLogin(AuthSessionPtr session)
-	{
-		m_session = session;
-	}
+	void setLogin(AuthSessionPtr session);
 
 signals:
 	/**
@@ -126,13 +107,21 @@ signals:
 	 */
 	void log(QString text, MessageLevel::Enum level = MessageLevel::MultiMC);
 
+	/**
+	 * @brief emitted with the output of the processes, in batches
+	 * @param lines the lines and their levels
+	 */
+	void logLines(QList<LogLine> lines);
+
 protected:
 	InstancePtr m_instance;
-	QString m_err_leftover;
-	QString m_out_leftover;
 	QProcess m_prepostlaunchprocess;
 	bool killed = false;
 	AuthSessionPtr m_session;
+	/// levels and censoring for the game output, knows the secrets of m_session
+	LogClassifier m_classifier;
+	/// decodes and classifies the output of the processes off the GUI thread
+	LogIngester m_ingester;
 	QString launchScript;
 	QString m_nativeFolder;
 
@@ -151,15 +140,5 @@ slots:
 	void on_stdOut();
 	void on_prepost_stdOut();
 	void on_prepost_stdErr();
-	void logOutput(const QStringList &lines,
-				   MessageLevel::Enum defaultLevel = MessageLevel::Message,
-				   bool guessLevel = true, bool censor = true);
-	void logOutput(QString line,
-				   MessageLevel::Enum defaultLevel = MessageLevel::Message,
-				   bool guessLevel = true, bool censor = true);
-
-private:
-	QString censorPrivateInfo(QString in);
-	MessageLevel::Enum guessLevel(const QString &message, MessageLevel::Enum defaultLevel);
-	MessageLevel::Enum getLevel(const QString &levelName);
+
 };
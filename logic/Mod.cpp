@@ -27,12 +27,12 @@
 #include "logic/settings/INIFile.h"
 #include "logger/QsLog.h"
 
-Mod::Mod(const QFileInfo &file)
+Mod::Mod(const QFileInfo &file, bool read_metadata)
 {
-	repath(file);
+	repath(file, read_metadata);
 }
 
-void Mod::repath(const QFileInfo &file)
+void Mod::repath(const QFileInfo &file, bool read_metadata)
 {
 	m_file = file;
 	QString name_base = file.fileName();
@@ -74,6 +74,12 @@ void Mod::repath(const QFileInfo &file)
 		m_name = name_base;
 	}
 
+	if (read_metadata)
+		readMetadata();
+}
+
+void Mod::readMetadata()
+{
 	if (m_type == MOD_ZIPFILE)
 	{
 		QuaZip zip(m_file.filePath());
@@ -148,6 +154,19 @@ void Mod::repath(const QFileInfo &file)
 	}
 }
 
+void Mod::saveMetadata(QDataStream &out) const
+{
+	out << m_mod_id << m_name << m_version << m_mcversion << m_homeurl << m_updateurl
+		<< m_description << m_authors << m_credits;
+}
+
+bool Mod::loadMetadata(QDataStream &in)
+{
+	in >> m_mod_id >> m_name >> m_version >> m_mcversion >> m_homeurl >> m_updateurl >>
+		m_description >> m_authors >> m_credits;
+	return in.status() == QDataStream::Ok;
+}
+
 // NEW format
 // https://github.com/MinecraftForge/FML/wiki/FML-mod-information-file/6f62b37cea040daf350dc253eae6326dd9c822c3
 
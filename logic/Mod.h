@@ -15,6 +15,7 @@
 
 #pragma once
 #include <QFileInfo>
+#include <QDataStream>
 
 class Mod
 {
@@ -28,7 +29,8 @@ public:
 		MOD_LITEMOD, //!< The mod is a litemod
 	};
 
-	Mod(const QFileInfo &file);
+	/// without read_metadata, only what the file name tells is known until readMetadata()
+	Mod(const QFileInfo &file, bool read_metadata = true);
 
 	QFileInfo filename() const
 	{
@@ -94,7 +96,18 @@ public:
 	// replace this mod with a copy of the other
 	bool replace(Mod &with);
 	// change the mod's filesystem path (used by mod lists for *MAGIC* purposes)
-	void repath(const QFileInfo &file);
+	void repath(const QFileInfo &file, bool read_metadata = true);
+
+	/// true if the mod has files with metadata (name, version...) in them
+	bool hasMetadataFiles() const
+	{
+		return m_type == MOD_ZIPFILE || m_type == MOD_LITEMOD || m_type == MOD_FOLDER;
+	}
+	/// read the metadata from the mod's files. Only touches this object.
+	void readMetadata();
+	/// the metadata in the form the mod index keeps it
+	void saveMetadata(QDataStream &out) const;
+	bool loadMetadata(QDataStream &in);
 
 	// WEAK compare operator - used for replacing mods
 	bool operator==(const Mod &other) const;
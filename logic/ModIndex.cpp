@@ -0,0 +1,118 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ModIndex.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDateTime>
+#include "logger/QsLog.h"
+
+static const quint32 indexMagic = 0x4d4d4d49; // "MMMI"
+static const quint32 indexVersion = 1;
+
+ModIndex::ModIndex(QString index_path) : m_index_path(index_path)
+{
+}
+
+void ModIndex::load()
+{
+	if (m_loaded)
+		return;
+	m_loaded = true;
+	m_entries.clear();
+	QFile file(m_index_path);
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+	QDataStream in(&file);
+	quint32 magic, version, count;
+	in >> magic >> version >> count;
+	if (in.status() != QDataStream::Ok || magic != indexMagic || version != indexVersion)
+		return;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		QString id;
+		Entry entry;
+		in >> id >> entry.size >> entry.mtime >> entry.metadata;
+		m_entries.insert(id, entry);
+	}
+	if (in.status() != QDataStream::Ok)
+	{
+		QLOG_WARN() << "Mod index" << m_index_path << "is damaged, mods will be read again";
+		m_entries.clear();
+	}
+}
+
+void ModIndex::save()
+{
+	QSaveFile file(m_index_path);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		QLOG_ERROR() << "Failed to save mod index" << m_index_path;
+		return;
+	}
+	QDataStream out(&file);
+	out << indexMagic << indexVersion << quint32(m_entries.size());
+	for (auto iter = m_entries.begin(); iter != m_entries.end(); iter++)
+	{
+		out << iter.key() << iter.value().size << iter.value().mtime << iter.value().metadata;
+	}
+	if (file.commit())
+		m_dirty = false;
+}
+
+bool ModIndex::lookup(Mod &mod) const
+{
+	auto iter = m_entries.constFind(mod.mmc_id());
+	if (iter == m_entries.constEnd())
+		return false;
+	const QFileInfo &file = mod.filename();
+	if (iter.value().size != file.size() ||
+		iter.value().mtime != file.lastModified().toMSecsSinceEpoch())
+		return false;
+	QDataStream in(iter.value().metadata);
+	return mod.loadMetadata(in);
+}
+
+void ModIndex::insert(const Mod &mod)
+{
+	QByteArray metadata;
+	QDataStream out(&metadata, QIODevice::WriteOnly);
+	mod.saveMetadata(out);
+	insert(mod.mmc_id(), mod.filename(), metadata);
+}
+
+void ModIndex::insert(const QString &mmc_id, const QFileInfo &file, const QByteArray &metadata)
+{
+	Entry entry;
+	entry.size = file.size();
+	entry.mtime = file.lastModified().toMSecsSinceEpoch();
+	entry.metadata = metadata;
+	m_entries.insert(mmc_id, entry);
+	m_dirty = true;
+}
+
+void ModIndex::retain(const QSet<QString> &mmc_ids)
+{
+	for (auto iter = m_entries.begin(); iter != m_entries.end();)
+	{
+		if (mmc_ids.contains(iter.key()))
+		{
+			iter++;
+			continue;
+		}
+		iter = m_entries.erase(iter);
+		m_dirty = true;
+	}
+}
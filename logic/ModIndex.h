@@ -0,0 +1,66 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QHash>
+#include <QSet>
+#include <QByteArray>
+
+#include "logic/Mod.h"
+
+/**
+ * Remembers the metadata of the mods in a folder, so files that didn't change don't have
+ * to be opened again. Entries are keyed on the mod id (file name without .disabled) and
+ * only used while the size and modification time of the file still match.
+ */
+class ModIndex
+{
+public:
+	explicit ModIndex(QString index_path);
+
+	void load();
+	void save();
+
+	/// fill in the metadata of the mod, if the index has it. false if it doesn't.
+	bool lookup(Mod &mod) const;
+
+	/// remember the metadata of the mod
+	void insert(const Mod &mod);
+
+	/// store metadata saved with Mod::saveMetadata for the given file
+	void insert(const QString &mmc_id, const QFileInfo &file, const QByteArray &metadata);
+
+	/// forget all the mods that aren't in the given set
+	void retain(const QSet<QString> &mmc_ids);
+
+	bool isDirty() const
+	{
+		return m_dirty;
+	}
+
+private:
+	struct Entry
+	{
+		qint64 size = -1;
+		qint64 mtime = 0;
+		QByteArray metadata;
+	};
+	QString m_index_path;
+	QHash<QString, Entry> m_entries;
+	bool m_loaded = false;
+	bool m_dirty = false;
+};
@@ -21,10 +21,39 @@
 #include <QUuid>
 #include <QString>
 #include <QFileSystemWatcher>
+#include <QDataStream>
+#include <QSet>
+#include <QtConcurrentMap>
 #include "logger/QsLog.h"
 
+// the index lives next to the folder, so writing it doesn't trigger the folder watcher
+static QString indexPathFor(const QString &dir)
+{
+	QFileInfo info(QDir(dir).absolutePath());
+	return PathCombine(info.path(), "." + info.fileName() + ".index");
+}
+
+namespace
+{
+// runs on the pool threads
+struct ModScanner
+{
+	typedef ModList::ScanResult result_type;
+	ModList::ScanResult operator()(const QString &path) const
+	{
+		Mod mod(QFileInfo(path), true);
+		ModList::ScanResult result;
+		result.path = path;
+		result.mmc_id = mod.mmc_id();
+		QDataStream out(&result.metadata, QIODevice::WriteOnly);
+		mod.saveMetadata(out);
+		return result;
+	}
+};
+}
+
 ModList::ModList(const QString &dir, const QString &list_file)
-	: QAbstractListModel(), m_dir(dir), m_list_file(list_file)
+	: QAbstractListModel(), m_dir(dir), m_list_file(list_file), m_index(indexPathFor(dir))
 {
 	ensureFolderPathExists(m_dir.absolutePath());
 	m_dir.setFilter(QDir::Readable | QDir::NoDotAndDotDot | QDir::Files | QDir::Dirs |
@@ -35,6 +64,8 @@ ModList::ModList(const QString &dir, const QString &list_file)
 	is_watching = false;
 	connect(m_watcher, SIGNAL(directoryChanged(QString)), this,
 			SLOT(directoryChanged(QString)));
+	connect(&m_scan_watcher, SIGNAL(resultReadyAt(int)), SLOT(scanResultReady(int)));
+	connect(&m_scan_watcher, SIGNAL(finished()), SLOT(scanFinished()));
 }
 
 void ModList::startWatching()
@@ -87,6 +118,33 @@ bool ModList::update()
 	auto folderContents = m_dir.entryInfoList();
 	bool orderOrStateChanged = false;
 
+	// anything still being read is about to be outdated
+	m_scan_watcher.cancel();
+	m_index.load();
+	QStringList toScan;
+	QSet<QString> present;
+	auto makeMod = [&](const QFileInfo &info) -> Mod
+	{
+		Mod mod(info, false);
+		present.insert(mod.mmc_id());
+		if (!mod.hasMetadataFiles())
+			return mod;
+		// folders can change inside without the folder itself changing, always read those
+		bool indexed = mod.type() != Mod::MOD_FOLDER;
+		if (indexed && m_index.lookup(mod))
+			return mod;
+		// with an order file, new mods are placed by name. It has to be known right away.
+		if (m_list_file.isEmpty())
+		{
+			toScan.append(info.filePath());
+			return mod;
+		}
+		mod.readMetadata();
+		if (indexed)
+			m_index.insert(mod);
+		return mod;
+	};
+
 	// first, process the ordered items (if any)
 	OrderList listOrder = readListFile();
 	for (auto item : listOrder)
@@ -119,7 +177,7 @@ bool ModList::update()
 			// remove from the actual folder contents list
 			folderContents.takeAt(idx);
 			// append the new mod
-			orderedMods.append(Mod(info));
+			orderedMods.append(makeMod(info));
 			if (isEnabled != item.enabled)
 				orderOrStateChanged = true;
 		}
@@ -134,7 +192,7 @@ bool ModList::update()
 		// the order surely changed!
 		for (auto entry : folderContents)
 		{
-			newMods.append(Mod(entry));
+			newMods.append(makeMod(entry));
 		}
 		internalSort(newMods);
 		orderedMods.append(newMods);
@@ -166,9 +224,69 @@ bool ModList::update()
 		saveListFile();
 		emit changed();
 	}
+
+	m_index.retain(present);
+	if (toScan.size())
+	{
+		QLOG_INFO() << "Reading" << toScan.size() << "mods in" << m_dir.absolutePath();
+		m_scan_watcher.setFuture(QtConcurrent::mapped(toScan, ModScanner()));
+	}
+	else if (m_index.isDirty())
+	{
+		m_index.save();
+	}
 	return true;
 }
 
+void ModList::scanResultReady(int index)
+{
+	ScanResult result = m_scan_watcher.resultAt(index);
+	for (int row = 0; row < mods.size(); row++)
+	{
+		Mod &mod = mods[row];
+		if (mod.filename().filePath() != result.path)
+			continue;
+		QDataStream in(result.metadata);
+		mod.loadMetadata(in);
+		if (mod.type() != Mod::MOD_FOLDER)
+			m_index.insert(result.mmc_id, mod.filename(), result.metadata);
+		emit dataChanged(this->index(row, 0), this->index(row, columnCount(QModelIndex()) - 1));
+		break;
+	}
+}
+
+void ModList::scanFinished()
+{
+	if (m_scan_watcher.isCanceled())
+		return;
+	// new mods were placed by their file name, now the real names are known
+	sortKeepingSelection();
+	if (m_index.isDirty())
+		m_index.save();
+}
+
+void ModList::sortKeepingSelection()
+{
+	emit layoutAboutToBeChanged();
+	QModelIndexList oldIndexes = persistentIndexList();
+	QStringList oldPaths;
+	for (auto &index : oldIndexes)
+	{
+		oldPaths.append(mods[index.row()].filename().filePath());
+	}
+	internalSort(mods);
+	QModelIndexList newIndexes;
+	for (int i = 0; i < oldIndexes.size(); i++)
+	{
+		int newRow = 0;
+		while (newRow < mods.size() && mods[newRow].filename().filePath() != oldPaths[i])
+			newRow++;
+		newIndexes.append(this->index(newRow, oldIndexes[i].column()));
+	}
+	changePersistentIndexList(oldIndexes, newIndexes);
+	emit layoutChanged();
+}
+
 void ModList::directoryChanged(QString path)
 {
 	update();
@@ -19,8 +19,10 @@
 #include <QString>
 #include <QDir>
 #include <QAbstractListModel>
+#include <QFutureWatcher>
 
 #include "logic/Mod.h"
+#include "logic/ModIndex.h"
 
 class LegacyInstance;
 class BaseInstance;
@@ -29,6 +31,10 @@ class QFileSystemWatcher;
 /**
  * A legacy mod list.
  * Backed by a folder.
+ *
+ * Mod metadata comes from an index stored next to the folder. Mods that are new or changed
+ * get read on the thread pool and show up in the model as they are done, except for lists
+ * with an order file, where the order depends on it.
  */
 class ModList : public QAbstractListModel
 {
@@ -126,8 +132,17 @@ public:
 		return m_dir;
 	}
 
+	/// metadata of a mod, read on the thread pool
+	struct ScanResult
+	{
+		QString path;
+		QString mmc_id;
+		QByteArray metadata;
+	};
+
 private:
 	void internalSort(QList<Mod> & what);
+	void sortKeepingSelection();
 	struct OrderItem
 	{
 		QString id;
@@ -139,6 +154,8 @@ private:
 private
 slots:
 	void directoryChanged(QString path);
+	void scanResultReady(int index);
+	void scanFinished();
 
 signals:
 	void changed();
@@ -150,4 +167,6 @@ protected:
 	QString m_list_file;
 	QString m_list_id;
 	QList<Mod> mods;
+	ModIndex m_index;
+	QFutureWatcher<ScanResult> m_scan_watcher;
 };
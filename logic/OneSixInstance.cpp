@@ -149,34 +149,56 @@ QDir OneSixInstance::reconstructAssets(std::shared_ptr<InstanceVersion> version)
 	{
 		QLOG_INFO() << "Reconstructing virtual assets folder at" << virtualRoot.path();
 
+		// the manifest says what is already in place, so we don't have to look at every file
+		auto manifest = AssetsUtils::loadVirtualManifest(virtualRoot);
+		bool manifestChanged = false;
+		QMap<FileLinkType, int> linkCounts;
+
 		for (QString map : index.objects.keys())
 		{
 			AssetObject asset_object = index.objects.value(map);
 			QString target_path = PathCombine(virtualRoot.path(), map);
-			QFile target(target_path);
-
 			QString tlk = asset_object.hash.left(2);
 
 			QString original_path =
 				PathCombine(PathCombine(objectDir.path(), tlk), asset_object.hash);
-			QFile original(original_path);
-			if (!original.exists())
+			// the target can be gone, or the object replaced since, e.g. when it was corrupt
+			if (manifest.value(map) == asset_object.hash &&
+				AssetsUtils::isPlacedObject(target_path, original_path))
+				continue;
+			if (!QFile::exists(original_path))
+				continue;
+
+			// anything already there is either outdated or a full copy made before linking
+			QFile::remove(target_path);
+			if (!ensureFilePathExists(target_path))
 				continue;
-			if (!target.exists())
+
+			auto linkType = linkOrCopyFile(original_path, target_path);
+			linkCounts[linkType]++;
+			if (linkType == FileLink_Failed)
 			{
-				QFileInfo info(target_path);
-				QDir target_dir = info.dir();
-				// QLOG_DEBUG() << target_dir;
-				if (!target_dir.exists())
-					QDir("").mkpath(target_dir.path());
-
-				bool couldCopy = original.copy(target_path);
-				QLOG_DEBUG() << " Copying" << original_path << "to" << target_path
-							 << QString::number(couldCopy); // << original.errorString();
+				QLOG_ERROR() << "Failed to place" << original_path << "at" << target_path;
+				continue;
 			}
+			manifest.insert(map, asset_object.hash);
+			manifestChanged = true;
 		}
+		if (linkCounts.size())
+		{
+			QLOG_INFO() << "Virtual assets:" << linkCounts.value(FileLink_Hard) << "hard links,"
+						<< linkCounts.value(FileLink_Reflink) << "reflinks,"
+						<< linkCounts.value(FileLink_Symbolic) << "symlinks,"
+						<< linkCounts.value(FileLink_Copy) << "copies,"
+						<< linkCounts.value(FileLink_Failed) << "failures";
+		}
+
+		if (manifestChanged)
+			AssetsUtils::saveVirtualManifest(virtualRoot, manifest);
+		AssetsUtils::markVirtualRootUsed(virtualRoot);
 
-		// TODO: Write last used time to virtualRoot/.lastused
+		// drop virtual roots nobody used in a month
+		AssetsUtils::removeUnusedVirtualRoots(virtualDir, 30);
 	}
 
 	return virtualRoot;
@@ -22,6 +22,7 @@
 #include <QFileInfo>
 #include <QTextStream>
 #include <QDataStream>
+#include <QtConcurrentMap>
 #include <pathutils.h>
 #include <JlCompress.h>
 
@@ -30,12 +31,22 @@
 #include "logic/minecraft/InstanceVersion.h"
 #include "logic/minecraft/OneSixLibrary.h"
 #include "logic/OneSixInstance.h"
+#include "logic/JarBuildCache.h"
 #include "logic/forge/ForgeMirrors.h"
 #include "logic/net/URLConstants.h"
+#include "logic/net/BatchDownload.h"
 #include "logic/assets/AssetsUtils.h"
+#include "logic/assets/AssetsVerifyTask.h"
 
 OneSixUpdate::OneSixUpdate(OneSixInstance *inst, QObject *parent) : Task(parent), m_inst(inst)
 {
+	connect(&libraryCheckWatcher, SIGNAL(finished()), SLOT(jarlibChecked()));
+}
+
+OneSixUpdate::~OneSixUpdate()
+{
+	// the checks write into libraryChecks
+	libraryCheckWatcher.waitForFinished();
 }
 
 void OneSixUpdate::executeTask()
@@ -118,28 +129,35 @@ void OneSixUpdate::assetIndexFinished()
 	if (!AssetsUtils::loadAssetsIndexJson(asset_fname, &index))
 	{
 		emitFailed(tr("Failed to read the assets index!"));
+		return;
 	}
 
-	QList<Md5EtagDownloadPtr> dls;
-	for (auto object : index.objects.values())
+	// check what we already have on worker threads, against the hashes from the index
+	setStatus(tr("Verifying assets..."));
+	assetsVerifyTask.reset(new AssetsVerifyTask(index.objects.values()));
+	connect(assetsVerifyTask.get(), SIGNAL(succeeded()), SLOT(assetsVerified()));
+	connect(assetsVerifyTask.get(), SIGNAL(progress(qint64, qint64)),
+			SIGNAL(progress(qint64, qint64)));
+	assetsVerifyTask->start();
+}
+
+void OneSixUpdate::assetsVerified()
+{
+	OneSixInstance *inst = (OneSixInstance *)m_inst;
+	// the objects are small and all come from the same host, fetch them in one batch
+	auto batch = BatchDownload::make(QUrl("http://" + URLConstants::RESOURCE_BASE));
+	for (auto object : assetsVerifyTask->invalidObjects())
 	{
 		QString objectName = object.hash.left(2) + "/" + object.hash;
-		QFileInfo objectFile("assets/objects/" + objectName);
-		if ((!objectFile.isFile()) || (objectFile.size() != object.size))
-		{
-			auto objectDL = MD5EtagDownload::make(
-				QUrl("http://" + URLConstants::RESOURCE_BASE + objectName),
-				objectFile.filePath());
-			objectDL->m_total_progress = object.size;
-			dls.append(objectDL);
-		}
+		// objects are named after their SHA-1
+		batch->addFile(objectName, "assets/objects/" + objectName, object.hash, object.size);
 	}
-	if (dls.size())
+	if (batch->fileCount())
 	{
 		setStatus(tr("Getting the assets files from Mojang..."));
 		auto job = new NetJob(tr("Assets for %1").arg(inst->name()));
-		for (auto dl : dls)
-			job->addNetAction(dl);
+		job->setPriority(Priority_Bulk);
+		job->addNetAction(batch);
 		jarlibDownloadJob.reset(job);
 		connect(jarlibDownloadJob.get(), SIGNAL(succeeded()), SLOT(assetsFinished()));
 		connect(jarlibDownloadJob.get(), SIGNAL(failed()), SLOT(assetsFailed()));
@@ -188,26 +206,19 @@ void OneSixUpdate::jarlibStart()
 
 	// Build a list of URLs that will need to be downloaded.
 	std::shared_ptr<InstanceVersion> version = inst->getFullVersion();
+	libraryChecks.clear();
 	// minecraft.jar for this version
 	{
 		QString version_id = version->id;
 		QString localPath = version_id + "/" + version_id + ".jar";
 		QString urlstr = "http://" + URLConstants::AWS_DOWNLOAD_VERSIONS + localPath;
-
-		auto job = new NetJob(tr("Libraries for instance %1").arg(inst->name()));
-
-		auto metacache = MMC->metacache();
-		auto entry = metacache->resolveEntry("versions", localPath);
-		job->addNetAction(CacheDownload::make(QUrl(urlstr), entry));
-		jarHashOnEntry = entry->md5sum;
-		jarlibDownloadJob.reset(job);
+		libraryChecks.append({"versions", localPath, urlstr, false, QStringList(),
+							  MetaEntryPtr()});
 	}
 
 	auto libs = version->getActiveNativeLibs();
 	libs.append(version->getActiveNormalLibs());
 
-	auto metacache = MMC->metacache();
-	QList<ForgeXzDownloadPtr> ForgeLibs;
 	QList<std::shared_ptr<OneSixLibrary>> brokenLocalLibs;
 
 	for (auto lib : libs)
@@ -224,18 +235,8 @@ void OneSixUpdate::jarlibStart()
 
 		auto f = [&](QString storage, QString dl)
 		{
-			auto entry = metacache->resolveEntry("libraries", storage);
-			if (entry->stale)
-			{
-				if (lib->hint() == "forge-pack-xz")
-				{
-					ForgeLibs.append(ForgeXzDownload::make(storage, entry));
-				}
-				else
-				{
-					jarlibDownloadJob->addNetAction(CacheDownload::make(dl, entry));
-				}
-			}
+			libraryChecks.append({"libraries", storage, dl, lib->hint() == "forge-pack-xz",
+								  lib->checksums(), MetaEntryPtr()});
 		};
 		if (raw_storage.contains("${arch}"))
 		{
@@ -253,7 +254,7 @@ void OneSixUpdate::jarlibStart()
 	}
 	if (!brokenLocalLibs.empty())
 	{
-		jarlibDownloadJob.reset();
+		libraryChecks.clear();
 		QStringList failed;
 		for (auto brokenLib : brokenLocalLibs)
 		{
@@ -266,6 +267,50 @@ void OneSixUpdate::jarlibStart()
 					  "outside of MultiMC.").arg(failed_all));
 		return;
 	}
+
+	// resolving an entry can mean hashing the whole file. Check everything in parallel,
+	// away from the GUI thread. jarlibChecked() picks up from there.
+	auto metacache = MMC->metacache();
+	libraryCheckWatcher.setFuture(QtConcurrent::map(libraryChecks, [metacache](LibraryCheck &check)
+	{
+		check.entry = metacache->resolveEntry(check.base, check.storage);
+	}));
+}
+
+void OneSixUpdate::jarlibChecked()
+{
+	OneSixInstance *inst = (OneSixInstance *)m_inst;
+	QList<LibraryCheck> checks;
+	checks.swap(libraryChecks);
+	if (checks.isEmpty())
+		return;
+
+	auto job = new NetJob(tr("Libraries for instance %1").arg(inst->name()));
+	jarlibDownloadJob.reset(job);
+
+	// the minecraft jar is always fetched, the download itself knows if it's current
+	LibraryCheck jar = checks.takeFirst();
+	job->addNetAction(CacheDownload::make(QUrl(jar.dl), jar.entry));
+	jarHashOnEntry = jar.entry->md5sum;
+
+	QList<ForgeXzDownloadPtr> ForgeLibs;
+	for (auto &check : checks)
+	{
+		if (!check.entry->stale)
+			continue;
+		if (check.forgeXz)
+		{
+			auto dl = ForgeXzDownload::make(check.storage, check.entry);
+			dl->m_hasher.expect(QCryptographicHash::Sha1, check.checksums);
+			ForgeLibs.append(dl);
+		}
+		else
+		{
+			auto dl = CacheDownload::make(check.dl, check.entry);
+			dl->m_hasher.expect(QCryptographicHash::Sha1, check.checksums);
+			job->addNetAction(dl);
+		}
+	}
 	// TODO: think about how to propagate this from the original json file... or IF AT ALL
 	QString forgeMirrorList = "http://files.minecraftforge.net/mirror-brand.list";
 	if (!ForgeLibs.empty())
@@ -333,6 +378,13 @@ void OneSixUpdate::stripJar(QString origPath, QString newPath)
 		return;
 	}
 
+	auto buildCache = MMC->jarBuildCache();
+	JarBuildCache::Key buildKey;
+	bool keyed = buildKey.addFile(QFileInfo(origPath));
+	buildKey.addPolicy("stripped");
+	if (keyed && buildCache->fetch(buildKey, runnableJar.filePath()))
+		return;
+
 	// TaskStep(); // STEP 1
 	setStatus(tr("Creating stripped jar: Opening minecraft.jar ..."));
 
@@ -352,6 +404,15 @@ void OneSixUpdate::stripJar(QString origPath, QString newPath)
 		emitFailed("Failed to add " + origPath + " to the jar.");
 		return;
 	}
+	zipOut.close();
+	if (zipOut.getZipError() != 0)
+	{
+		QFile::remove(runnableJar.filePath());
+		emitFailed("Failed to finalize the stripped jar!");
+		return;
+	}
+	if (keyed)
+		buildCache->store(buildKey, runnableJar.filePath());
 }
 
 bool OneSixUpdate::MergeZipFiles(QuaZip *into, QString from)
@@ -359,49 +420,34 @@ bool OneSixUpdate::MergeZipFiles(QuaZip *into, QString from)
 	setStatus(tr("Installing mods: Adding ") + from + " ...");
 
 	QuaZip modZip(from);
-	modZip.open(QuaZip::mdUnzip);
+	// our own copy of the jar, nobody changes it while the build runs
+	modZip.setMemoryMappingEnabled(true);
+	if (!modZip.open(QuaZip::mdUnzip))
+	{
+		QLOG_ERROR() << "Failed to open " << from;
+		return false;
+	}
 
-	QuaZipFile fileInsideMod(&modZip);
-	QuaZipFile zipOutFile(into);
+	int added = 0, skippedMetainf = 0;
 	for (bool more = modZip.goToFirstFile(); more; more = modZip.goToNextFile())
 	{
 		QString filename = modZip.getCurrentFileName();
 		if (filename.contains("META-INF"))
 		{
-			QLOG_INFO() << "Skipping META-INF " << filename << " from " << from;
+			skippedMetainf++;
 			continue;
 		}
-		QLOG_INFO() << "Adding file " << filename << " from " << from;
 
-		if (!fileInsideMod.open(QIODevice::ReadOnly))
-		{
-			QLOG_ERROR() << "Failed to open " << filename << " from " << from;
-			return false;
-		}
-		/*
-		QuaZipFileInfo old_info;
-		fileInsideMod.getFileInfo(&old_info);
-		*/
-		QuaZipNewInfo info_out(fileInsideMod.getActualFileName());
-		/*
-		info_out.externalAttr = old_info.externalAttr;
-		*/
-		if (!zipOutFile.open(QIODevice::WriteOnly, info_out))
-		{
-			QLOG_ERROR() << "Failed to open " << filename << " in the jar";
-			fileInsideMod.close();
-			return false;
-		}
-		if (!JlCompress::copyData(fileInsideMod, zipOutFile))
+		// the compressed data goes in as it is, no need to inflate and deflate it again
+		if (!JlCompress::copyRawFile(&modZip, into))
 		{
-			zipOutFile.close();
-			fileInsideMod.close();
-			QLOG_ERROR() << "Failed to copy data of " << filename << " into the jar";
+			QLOG_ERROR() << "Failed to copy " << filename << " from " << from << " into the jar";
 			return false;
 		}
-		zipOutFile.close();
-		fileInsideMod.close();
+		added++;
 	}
+	QLOG_INFO() << "Added" << added << "files from" << from << "- skipped" << skippedMetainf
+				<< "META-INF";
 	return true;
 }
 
@@ -18,10 +18,13 @@
 #include <QObject>
 #include <QList>
 #include <QUrl>
+#include <QFutureWatcher>
 
 #include "logic/net/NetJob.h"
 #include "logic/tasks/Task.h"
 #include "logic/VersionFilterData.h"
+#include "logic/assets/AssetsVerifyTask.h"
+#include "logic/net/HttpMetaCache.h"
 #include <quazip.h>
 
 class MinecraftVersion;
@@ -32,6 +35,7 @@ class OneSixUpdate : public Task
 	Q_OBJECT
 public:
 	explicit OneSixUpdate(OneSixInstance *inst, QObject *parent = 0);
+	virtual ~OneSixUpdate();
 	virtual void executeTask();
 
 private
@@ -39,6 +43,7 @@ slots:
 	void versionUpdateFailed(QString reason);
 
 	void jarlibStart();
+	void jarlibChecked();
 	void jarlibFinished();
 	void jarlibFailed();
 
@@ -49,6 +54,7 @@ slots:
 	void assetIndexStart();
 	void assetIndexFinished();
 	void assetIndexFailed();
+	void assetsVerified();
 
 	void assetsFinished();
 	void assetsFailed();
@@ -56,6 +62,20 @@ slots:
 	void stripJar(QString origPath, QString newPath);
 	bool MergeZipFiles(QuaZip *into, QString from);
 private:
+	/// a file to resolve in the metacache, and where to get it if it's stale
+	struct LibraryCheck
+	{
+		QString base;
+		QString storage;
+		QString dl;
+		bool forgeXz;
+		QStringList checksums;
+		MetaEntryPtr entry;
+	};
+	/// the minecraft jar first, then the libraries. Resolved on the thread pool.
+	QList<LibraryCheck> libraryChecks;
+	QFutureWatcher<void> libraryCheckWatcher;
+
 	NetJobPtr jarlibDownloadJob;
 	NetJobPtr legacyDownloadJob;
 
@@ -63,6 +83,8 @@ private:
 	std::shared_ptr<MinecraftVersion> targetVersion;
 	/// the task that is spawned for version updates
 	std::shared_ptr<Task> versionUpdateTask;
+	/// checks the assets objects before downloading what's missing
+	std::shared_ptr<AssetsVerifyTask> assetsVerifyTask;
 	
 	OneSixInstance *m_inst = nullptr;
 	QString jarHashOnEntry;
@@ -19,10 +19,20 @@
 #include <QJsonParseError>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QSaveFile>
+#include <QDateTime>
+#include <pathutils.h>
 
 #include "AssetsUtils.h"
 #include "MultiMC.h"
 
+#ifndef Q_OS_WIN
+#include <sys/stat.h>
+#endif
+
+static const QString manifestName = ".manifest";
+static const QString lastUsedName = ".lastused";
+
 namespace AssetsUtils
 {
 int findLegacyAssets()
@@ -151,4 +161,105 @@ bool loadAssetsIndexJson(QString path, AssetsIndex *index)
 
 	return true;
 }
+
+/*
+ * The manifest is a list of "<hash> <path>" lines, one for each file linked into the root.
+ */
+VirtualAssetsManifest loadVirtualManifest(QDir virtualRoot)
+{
+	VirtualAssetsManifest manifest;
+	QFile file(virtualRoot.filePath(manifestName));
+	if (!file.open(QIODevice::ReadOnly))
+		return manifest;
+	while (!file.atEnd())
+	{
+		QByteArray line = file.readLine();
+		if (line.endsWith('\n'))
+			line.chop(1);
+		int separator = line.indexOf(' ');
+		if (separator <= 0)
+			continue;
+		manifest.insert(QString::fromUtf8(line.mid(separator + 1)),
+						QString::fromLatin1(line.left(separator)));
+	}
+	return manifest;
+}
+
+bool saveVirtualManifest(QDir virtualRoot, const VirtualAssetsManifest &manifest)
+{
+	QSaveFile file(virtualRoot.filePath(manifestName));
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		QLOG_ERROR() << "Failed to write virtual assets manifest in" << virtualRoot.path();
+		return false;
+	}
+	QByteArray data;
+	for (auto iter = manifest.begin(); iter != manifest.end(); iter++)
+	{
+		data.append(iter.value().toLatin1());
+		data.append(' ');
+		data.append(iter.key().toUtf8());
+		data.append('\n');
+	}
+	if (file.write(data) != data.size())
+	{
+		file.cancelWriting();
+		return false;
+	}
+	return file.commit();
+}
+
+bool isPlacedObject(const QString &target, const QString &object)
+{
+	// links share the object's file, copies and reflinks were made after it was
+#ifdef Q_OS_WIN
+	QFileInfo targetInfo(target);
+	QFileInfo objectInfo(object);
+	return targetInfo.isFile() && objectInfo.isFile() && targetInfo.size() == objectInfo.size() &&
+		   targetInfo.lastModified() >= objectInfo.lastModified();
+#else
+	// stat() follows symlinks, a dangling one fails here
+	struct stat targetStat, objectStat;
+	if (::stat(QFile::encodeName(target).constData(), &targetStat) != 0 ||
+		::stat(QFile::encodeName(object).constData(), &objectStat) != 0)
+		return false;
+	if (!S_ISREG(targetStat.st_mode) || targetStat.st_size != objectStat.st_size)
+		return false;
+	if (targetStat.st_dev == objectStat.st_dev && targetStat.st_ino == objectStat.st_ino)
+		return true;
+	return targetStat.st_mtime >= objectStat.st_mtime;
+#endif
+}
+
+void markVirtualRootUsed(QDir virtualRoot)
+{
+	QSaveFile file(virtualRoot.filePath(lastUsedName));
+	if (!file.open(QIODevice::WriteOnly))
+		return;
+	file.write(QByteArray::number(QDateTime::currentMSecsSinceEpoch()));
+	file.commit();
+}
+
+int removeUnusedVirtualRoots(QDir virtualDir, int maxAgeDays)
+{
+	int removed = 0;
+	auto limit = QDateTime::currentDateTime().addDays(-maxAgeDays).toMSecsSinceEpoch();
+	for (auto entry : virtualDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot))
+	{
+		// only touch roots we know about - the ones that record their last use
+		QFile lastUsedFile(PathCombine(entry.filePath(), lastUsedName));
+		if (!lastUsedFile.open(QIODevice::ReadOnly))
+			continue;
+		bool ok = false;
+		qint64 lastUsed = lastUsedFile.readAll().trimmed().toLongLong(&ok);
+		lastUsedFile.close();
+		if (!ok || lastUsed >= limit)
+			continue;
+		QLOG_INFO() << "Removing unused virtual assets" << entry.filePath();
+		// the objects are links, this doesn't touch the object store
+		if (QDir(entry.filePath()).removeRecursively())
+			removed++;
+	}
+	return removed;
+}
 }
@@ -17,6 +17,8 @@
 
 #include <QString>
 #include <QMap>
+#include <QHash>
+#include <QDir>
 
 struct AssetObject
 {
@@ -30,8 +32,24 @@ struct AssetsIndex
 	bool isVirtual = false;
 };
 
+/// what a virtual assets root contains: path inside the root -> hash of the linked object
+typedef QHash<QString, QString> VirtualAssetsManifest;
+
 namespace AssetsUtils
 {
 bool loadAssetsIndexJson(QString file, AssetsIndex* index);
 int findLegacyAssets();
+
+/// Read the manifest of a virtual assets root. Empty if there is none.
+VirtualAssetsManifest loadVirtualManifest(QDir virtualRoot);
+bool saveVirtualManifest(QDir virtualRoot, const VirtualAssetsManifest &manifest);
+
+/// Whether the file at target still is what linkOrCopyFile() made of the object.
+bool isPlacedObject(const QString &target, const QString &object);
+
+/// Record that a virtual assets root was used just now.
+void markVirtualRootUsed(QDir virtualRoot);
+
+/// Remove the virtual assets roots which were not used for maxAgeDays. Returns how many.
+int removeUnusedVirtualRoots(QDir virtualDir, int maxAgeDays);
 }
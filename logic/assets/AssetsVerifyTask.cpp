@@ -0,0 +1,216 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AssetsVerifyTask.h"
+#include "logger/QsLog.h"
+#include <QtConcurrentMap>
+#include <QCryptographicHash>
+#include <QDirIterator>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDateTime>
+
+#ifndef Q_OS_WIN
+#include <sys/stat.h>
+#endif
+
+static const QString objectsDir = "assets/objects";
+static const QString stampsFile = "assets/objects/.verified";
+static const quint32 stampsMagic = 0x4d4d4356; // "MMCV"
+static const quint32 stampsVersion = 1;
+
+static QString objectPath(const QString &hash)
+{
+	return objectsDir + "/" + hash.left(2) + "/" + hash;
+}
+
+static bool statFile(const QString &path, AssetFileStamp &stamp)
+{
+#ifdef Q_OS_WIN
+	QFileInfo info(path);
+	if (!info.isFile())
+		return false;
+	stamp.size = info.size();
+	stamp.mtime = info.lastModified().toMSecsSinceEpoch();
+#else
+	struct stat st;
+	if (::stat(QFile::encodeName(path).constData(), &st) != 0 || !S_ISREG(st.st_mode))
+		return false;
+	stamp.inode = st.st_ino;
+	stamp.size = st.st_size;
+	stamp.mtime = qint64(st.st_mtime) * 1000;
+#endif
+	return true;
+}
+
+namespace
+{
+// runs on the pool threads. The stamps are only read there.
+struct AssetChecker
+{
+	typedef AssetCheck result_type;
+	QHash<QString, AssetFileStamp> stamps;
+
+	AssetCheck operator()(const AssetObject &object) const
+	{
+		AssetCheck check;
+		check.object = object;
+		QString path = objectPath(object.hash);
+		if (!statFile(path, check.stamp))
+			return check;
+		if (object.size >= 0 && check.stamp.size != object.size)
+			return check;
+
+		// already verified and didn't change since
+		auto known = stamps.constFind(object.hash);
+		if (known != stamps.constEnd() && known.value() == check.stamp)
+		{
+			check.valid = true;
+			return check;
+		}
+
+		QFile file(path);
+		if (!file.open(QIODevice::ReadOnly))
+			return check;
+		QCryptographicHash sha1(QCryptographicHash::Sha1);
+		sha1.addData(&file);
+		check.hashed = true;
+		check.valid = sha1.result().toHex() == object.hash.toLatin1();
+		return check;
+	}
+};
+}
+
+AssetsVerifyTask::AssetsVerifyTask(QList<AssetObject> objects, QObject *parent)
+	: Task(parent), m_objects(objects)
+{
+	connect(&m_watcher, SIGNAL(progressValueChanged(int)), SLOT(checksProgress(int)));
+	connect(&m_watcher, SIGNAL(finished()), SLOT(checksFinished()));
+}
+
+AssetsVerifyTask::AssetsVerifyTask(QObject *parent) : Task(parent), m_wholeStore(true)
+{
+	connect(&m_watcher, SIGNAL(progressValueChanged(int)), SLOT(checksProgress(int)));
+	connect(&m_watcher, SIGNAL(finished()), SLOT(checksFinished()));
+}
+
+AssetsVerifyTask::~AssetsVerifyTask()
+{
+	m_watcher.cancel();
+	m_watcher.waitForFinished();
+}
+
+void AssetsVerifyTask::executeTask()
+{
+	setStatus(tr("Verifying assets..."));
+	m_invalid.clear();
+	if (m_wholeStore)
+	{
+		m_objects.clear();
+		QDirIterator iter(objectsDir, QDir::Files, QDirIterator::Subdirectories);
+		while (iter.hasNext())
+		{
+			iter.next();
+			// objects are named after their hash and live in a folder named by its start
+			QString hash = iter.fileName();
+			if (hash.size() != 40 || !iter.filePath().endsWith(hash.left(2) + "/" + hash))
+				continue;
+			AssetObject object;
+			object.hash = hash;
+			object.size = -1;
+			m_objects.append(object);
+		}
+	}
+	loadStamps();
+
+	AssetChecker checker;
+	checker.stamps = m_stamps;
+	m_watcher.setFuture(QtConcurrent::mapped(m_objects, checker));
+}
+
+void AssetsVerifyTask::checksProgress(int value)
+{
+	emit progress(value, m_objects.size());
+}
+
+void AssetsVerifyTask::checksFinished()
+{
+	int hashed = 0;
+	for (auto check : m_watcher.future().results())
+	{
+		if (check.hashed)
+			hashed++;
+		if (check.valid)
+		{
+			m_stamps.insert(check.object.hash, check.stamp);
+			continue;
+		}
+		m_stamps.remove(check.object.hash);
+		m_invalid.append(check.object);
+		if (m_removeInvalid && check.stamp.size >= 0)
+		{
+			QLOG_WARN() << "Removing corrupt asset object" << check.object.hash;
+			QFile::remove(objectPath(check.object.hash));
+		}
+	}
+	QLOG_INFO() << "Verified" << m_objects.size() << "assets objects, hashed" << hashed
+				<< "of them," << m_invalid.size() << "missing or invalid.";
+	if (hashed || m_invalid.size())
+		saveStamps();
+	emitSucceeded();
+}
+
+void AssetsVerifyTask::loadStamps()
+{
+	m_stamps.clear();
+	QFile file(stampsFile);
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+	QDataStream in(&file);
+	quint32 magic, version, count;
+	in >> magic >> version >> count;
+	if (magic != stampsMagic || version != stampsVersion)
+		return;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		QString hash;
+		AssetFileStamp stamp;
+		in >> hash >> stamp.inode >> stamp.mtime >> stamp.size;
+		m_stamps.insert(hash, stamp);
+	}
+	if (in.status() != QDataStream::Ok)
+	{
+		QLOG_WARN() << "Assets verification data is damaged, everything will be verified again";
+		m_stamps.clear();
+	}
+}
+
+void AssetsVerifyTask::saveStamps()
+{
+	QSaveFile file(stampsFile);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		QLOG_ERROR() << "Failed to save assets verification data";
+		return;
+	}
+	QDataStream out(&file);
+	out << stampsMagic << stampsVersion << quint32(m_stamps.size());
+	for (auto iter = m_stamps.begin(); iter != m_stamps.end(); iter++)
+	{
+		out << iter.key() << iter.value().inode << iter.value().mtime << iter.value().size;
+	}
+	file.commit();
+}
@@ -0,0 +1,91 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include "logic/tasks/Task.h"
+#include "AssetsUtils.h"
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+
+/// identifies the state of a file on disk, without looking at its contents
+struct AssetFileStamp
+{
+	quint64 inode = 0;
+	qint64 mtime = 0;
+	qint64 size = -1;
+	bool operator==(const AssetFileStamp &other) const
+	{
+		return inode == other.inode && mtime == other.mtime && size == other.size;
+	}
+};
+
+/// result of checking one object
+struct AssetCheck
+{
+	AssetObject object;
+	AssetFileStamp stamp;
+	bool valid = false;
+	bool hashed = false;
+};
+
+/**
+ * Checks assets objects against their SHA-1 on a thread pool.
+ *
+ * Objects that passed before and didn't change on disk since (same inode, mtime and size)
+ * are not hashed again. That information is kept in assets/objects/.verified
+ */
+class AssetsVerifyTask : public Task
+{
+	Q_OBJECT
+public:
+	/// verify the given objects
+	explicit AssetsVerifyTask(QList<AssetObject> objects, QObject *parent = 0);
+	/// verify everything in the object store
+	explicit AssetsVerifyTask(QObject *parent = 0);
+	virtual ~AssetsVerifyTask();
+
+	/// remove the objects that fail verification, so they get downloaded again
+	void setRemoveInvalid(bool remove)
+	{
+		m_removeInvalid = remove;
+	}
+
+	/// objects that are missing or don't match their hash. Valid after the task finishes.
+	QList<AssetObject> invalidObjects() const
+	{
+		return m_invalid;
+	}
+
+protected:
+	virtual void executeTask();
+
+private
+slots:
+	void checksProgress(int value);
+	void checksFinished();
+
+private:
+	void loadStamps();
+	void saveStamps();
+
+private:
+	QList<AssetObject> m_objects;
+	bool m_wholeStore = false;
+	bool m_removeInvalid = false;
+	QHash<QString, AssetFileStamp> m_stamps;
+	QList<AssetObject> m_invalid;
+	QFutureWatcher<AssetCheck> m_watcher;
+};
@@ -361,7 +361,9 @@ protected:
 		if (entry->stale)
 		{
 			NetJob *fjob = new NetJob("Forge download");
-			fjob->addNetAction(CacheDownload::make(forgeVersion->url(), entry));
+			auto dl = CacheDownload::make(forgeVersion->url(), entry);
+			dl->m_hasher.expectHex(forgeVersion->checksum());
+			fjob->addNetAction(dl);
 			connect(fjob, &NetJob::progress, [this](qint64 current, qint64 total)
 			{ setProgress(100 * current / qMax((qint64)1, total)); });
 			connect(fjob, &NetJob::status, [this](const QString & msg)
@@ -53,3 +53,8 @@ QString ForgeVersion::url()
 {
 	return usesInstaller() ? installer_url : universal_url;
 }
+
+QString ForgeVersion::checksum()
+{
+	return usesInstaller() ? installer_checksum : universal_checksum;
+}
@@ -16,6 +16,7 @@ struct ForgeVersion : public BaseVersion
 
 	QString filename();
 	QString url();
+	QString checksum();
 	
 	enum
 	{
@@ -36,6 +37,9 @@ struct ForgeVersion : public BaseVersion
 	QString mcver_sane;
 	QString universal_filename;
 	QString installer_filename;
+	/// hex encoded hashes of the files, when the version list has them
+	QString universal_checksum;
+	QString installer_checksum;
 	bool is_recommended = false;
 };
 
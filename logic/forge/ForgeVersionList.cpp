@@ -161,6 +161,7 @@ void ForgeListLoadTask::executeTask()
 {
 	setStatus(tr("Fetching Forge version lists..."));
 	auto job = new NetJob("Version index");
+	job->setPriority(Priority_Interactive);
 	// we do not care if the version is stale or not.
 	auto forgeListEntry = MMC->metacache()->resolveEntry("minecraftforge", "list.json");
 	auto gradleForgeListEntry = MMC->metacache()->resolveEntry("minecraftforge", "json");
@@ -355,7 +356,6 @@ bool ForgeListLoadTask::parseForgeGradleList(QList<BaseVersionPtr> &out)
 		QJsonArray files = number.value("files").toArray();
 		for (auto fIt = files.begin(); fIt != files.end(); ++fIt)
 		{
-			// TODO with gradle we also get checksums, use them
 			QJsonArray file = (*fIt).toArray();
 			if (file.size() < 3)
 			{
@@ -382,11 +382,13 @@ bool ForgeListLoadTask::parseForgeGradleList(QList<BaseVersionPtr> &out)
 			if (part == "installer")
 			{
 				fVersion->installer_url = url;
+				fVersion->installer_checksum = checksum;
 				installer_filename = filename;
 			}
 			else if (part == "universal")
 			{
 				fVersion->universal_url = url;
+				fVersion->universal_checksum = checksum;
 				universal_filename = filename;
 			}
 			else if (part == "changelog")
@@ -17,17 +17,14 @@
 #include "ForgeXzDownload.h"
 #include <pathutils.h>
 
-#include <QCryptographicHash>
 #include <QFileInfo>
 #include <QDateTime>
-#include <QDir>
 #include "logger/QsLog.h"
 
 ForgeXzDownload::ForgeXzDownload(QString relative_path, MetaEntryPtr entry) : NetAction()
 {
 	m_entry = entry;
 	m_target_path = entry->getFullPath();
-	m_pack200_xz_file.setFileTemplate("./dl_temp.XXXXXX");
 	m_status = Job_NotStarted;
 	m_url_path = relative_path;
 }
@@ -61,6 +58,9 @@ void ForgeXzDownload::start()
 		emit failed(m_index_within_job);
 		return;
 	}
+	// anything left over from a previous attempt is useless now
+	discardStream();
+	m_fed = false;
 
 	QLOG_INFO() << "Downloading " << m_url.toString();
 	QNetworkRequest request(m_url);
@@ -119,37 +119,21 @@ void ForgeXzDownload::updateUrl()
 
 void ForgeXzDownload::downloadFinished()
 {
-	//TEST: defer to other possible mirrors (autofail the first one)
-	/*
-	QLOG_INFO() <<"dl " << index_within_job << " mirror " << m_mirror_index;
-	if( m_mirror_index == 0)
-	{
-		QLOG_INFO() <<"dl " << index_within_job << " AUTOFAIL";
-		m_status = Job_Failed;
-		m_pack200_xz_file.close();
-		m_pack200_xz_file.remove();
-		m_reply.reset();
-		failAndTryNextMirror();
-		return;
-	}
-	*/
-
 	// if the download succeeded
 	if (m_status != Job_Failed)
 	{
-		// nothing went wrong...
-		m_status = Job_Finished;
-		if (m_pack200_xz_file.isOpen())
+		if (m_stream)
 		{
-			// we actually downloaded something! process and isntall it
-			decompressAndInstall();
+			// we actually downloaded something! the unpacker takes it from here
+			m_etag = m_reply->rawHeader("ETag").constData();
+			m_reply.reset();
+			m_stream->finish();
 			return;
 		}
 		else
 		{
 			// something bad happened -- on the local machine!
 			m_status = Job_Failed;
-			m_pack200_xz_file.remove();
 			m_reply.reset();
 			emit failed(m_index_within_job);
 			return;
@@ -159,8 +143,7 @@ void ForgeXzDownload::downloadFinished()
 	else
 	{
 		m_status = Job_Failed;
-		m_pack200_xz_file.close();
-		m_pack200_xz_file.remove();
+		discardStream();
 		m_reply.reset();
 		failAndTryNextMirror();
 		return;
@@ -169,221 +152,68 @@ void ForgeXzDownload::downloadFinished()
 
 void ForgeXzDownload::downloadReadyRead()
 {
-
-	if (!m_pack200_xz_file.isOpen())
+	QByteArray data = m_reply->readAll();
+	// an error page, or the rest of an attempt that already failed
+	if (m_status == Job_Failed)
+		return;
+	if (!m_stream)
 	{
-		if (!m_pack200_xz_file.open())
-		{
-			/*
-			* Can't open the file... the job failed
-			*/
-			m_reply->abort();
-			emit failed(m_index_within_job);
+		// xz can only be unpacked from the start of the reply
+		if (m_fed)
 			return;
-		}
+		startUnpacking();
 	}
-	m_pack200_xz_file.write(m_reply->readAll());
+	m_fed = true;
+	m_stream->feed(data);
 }
 
-#include "xz.h"
-#include "unpack200.h"
-#include <stdexcept>
-
-const size_t buffer_size = 8196;
-
-void ForgeXzDownload::decompressAndInstall()
+void ForgeXzDownload::startUnpacking()
 {
-	// rewind the downloaded temp file
-	m_pack200_xz_file.seek(0);
-	// de-xz'd file
-	QTemporaryFile pack200_file("./dl_temp.XXXXXX");
-	pack200_file.open();
-
-	bool xz_success = false;
-	// first, de-xz
-	{
-		uint8_t in[buffer_size];
-		uint8_t out[buffer_size];
-		struct xz_buf b;
-		struct xz_dec *s;
-		enum xz_ret ret;
-		xz_crc32_init();
-		xz_crc64_init();
-		s = xz_dec_init(XZ_DYNALLOC, 1 << 26);
-		if (s == nullptr)
-		{
-			xz_dec_end(s);
-			failAndTryNextMirror();
-			return;
-		}
-		b.in = in;
-		b.in_pos = 0;
-		b.in_size = 0;
-		b.out = out;
-		b.out_pos = 0;
-		b.out_size = buffer_size;
-		while (!xz_success)
-		{
-			if (b.in_pos == b.in_size)
-			{
-				b.in_size = m_pack200_xz_file.read((char *)in, sizeof(in));
-				b.in_pos = 0;
-			}
-
-			ret = xz_dec_run(s, &b);
-
-			if (b.out_pos == sizeof(out))
-			{
-				if (pack200_file.write((char *)out, b.out_pos) != b.out_pos)
-				{
-					// msg = "Write error\n";
-					xz_dec_end(s);
-					failAndTryNextMirror();
-					return;
-				}
-
-				b.out_pos = 0;
-			}
-
-			if (ret == XZ_OK)
-				continue;
-
-			if (ret == XZ_UNSUPPORTED_CHECK)
-			{
-				// unsupported check. this is OK, but we should log this
-				continue;
-			}
-
-			if (pack200_file.write((char *)out, b.out_pos) != b.out_pos)
-			{
-				// write error
-				pack200_file.close();
-				xz_dec_end(s);
-				return;
-			}
-
-			switch (ret)
-			{
-			case XZ_STREAM_END:
-				xz_dec_end(s);
-				xz_success = true;
-				break;
-
-			case XZ_MEM_ERROR:
-				QLOG_ERROR() << "Memory allocation failed\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_MEMLIMIT_ERROR:
-				QLOG_ERROR() << "Memory usage limit reached\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_FORMAT_ERROR:
-				QLOG_ERROR() << "Not a .xz file\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_OPTIONS_ERROR:
-				QLOG_ERROR() << "Unsupported options in the .xz headers\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_DATA_ERROR:
-			case XZ_BUF_ERROR:
-				QLOG_ERROR() << "File is corrupt\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			default:
-				QLOG_ERROR() << "Bug!\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-			}
-		}
-	}
-	m_pack200_xz_file.remove();
+	m_stream = std::make_shared<ForgeXzStream>();
+	connect(m_stream.get(), SIGNAL(unpacked(QString)), SLOT(unpackFinished(QString)));
+	connect(m_stream.get(), SIGNAL(unpackFailed(QString)), SLOT(unpackFailed(QString)));
+	ForgeXzUnpacker::pool()->start(new ForgeXzUnpacker(m_stream, m_target_path, m_hasher));
+}
 
-	// revert pack200
-	pack200_file.seek(0);
-	int handle_in = pack200_file.handle();
-	// FIXME: dispose of file handles, pointers and the like. Ideally wrap in objects.
-	if(handle_in == -1)
-	{
-		QLOG_ERROR() << "Error reopening " << pack200_file.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	FILE * file_in = fdopen(handle_in,"r");
-	if(!file_in)
-	{
-		QLOG_ERROR() << "Error reopening " << pack200_file.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	QFile qfile_out(m_target_path);
-	if(!qfile_out.open(QIODevice::WriteOnly))
-	{
-		QLOG_ERROR() << "Error opening " << qfile_out.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	int handle_out = qfile_out.handle();
-	if(handle_out == -1)
-	{
-		QLOG_ERROR() << "Error opening " << qfile_out.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	FILE * file_out = fdopen(handle_out,"w");
-	if(!file_out)
-	{
-		QLOG_ERROR() << "Error opening " << qfile_out.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	try
-	{
-		unpack_200(file_in, file_out);
-	}
-	catch (std::runtime_error &err)
-	{
-		m_status = Job_Failed;
-		QLOG_ERROR() << "Error unpacking " << pack200_file.fileName() << " : " << err.what();
-		QFile f(m_target_path);
-		if (f.exists())
-			f.remove();
-		failAndTryNextMirror();
+void ForgeXzDownload::discardStream()
+{
+	if (!m_stream)
 		return;
-	}
-	pack200_file.remove();
-
-	QFile jar_file(m_target_path);
+	disconnect(m_stream.get(), 0, this, 0);
+	m_stream->abort();
+	m_stream.reset();
+}
 
-	if (!jar_file.open(QIODevice::ReadOnly))
-	{
-		jar_file.remove();
-		failAndTryNextMirror();
+void ForgeXzDownload::discardReply()
+{
+	if (!m_reply)
 		return;
-	}
-	m_entry->md5sum = QCryptographicHash::hash(jar_file.readAll(), QCryptographicHash::Md5)
-						  .toHex()
-						  .constData();
-	jar_file.close();
+	disconnect(m_reply.get(), 0, this, 0);
+	m_reply->abort();
+	m_reply.reset();
+}
+
+void ForgeXzDownload::unpackFinished(QString md5sum)
+{
+	m_stream.reset();
 
 	QFileInfo output_file_info(m_target_path);
-	m_entry->etag = m_reply->rawHeader("ETag").constData();
+	m_entry->md5sum = md5sum;
+	m_entry->etag = m_etag;
 	m_entry->local_changed_timestamp =
 		output_file_info.lastModified().toUTC().toMSecsSinceEpoch();
 	m_entry->stale = false;
 	MMC->metacache()->updateEntry(m_entry);
 
-	m_reply.reset();
+	m_status = Job_Finished;
 	emit succeeded(m_index_within_job);
 }
+
+void ForgeXzDownload::unpackFailed(QString reason)
+{
+	QLOG_ERROR() << reason;
+	m_stream.reset();
+	// the rest of the reply is useless, and must not fail this attempt a second time
+	discardReply();
+	failAndTryNextMirror();
+}
@@ -17,9 +17,8 @@
 
 #include "logic/net/NetAction.h"
 #include "logic/net/HttpMetaCache.h"
-#include <QFile>
-#include <QTemporaryFile>
 #include "ForgeMirror.h"
+#include "ForgeXzUnpacker.h"
 
 typedef std::shared_ptr<class ForgeXzDownload> ForgeXzDownloadPtr;
 
@@ -30,8 +29,12 @@ public:
 	MetaEntryPtr m_entry;
 	/// if saving to file, use the one specified in this string
 	QString m_target_path;
-	/// this is the output file, if any
-	QTemporaryFile m_pack200_xz_file;
+	/// the downloaded data goes here, to be unpacked by a worker. Null until data arrives.
+	ForgeXzStreamPtr m_stream;
+	/// true once data of the current reply went to an unpacker
+	bool m_fed = false;
+	/// ETag of the reply, applied to the entry once the unpacking succeeds
+	QString m_etag;
 	/// mirror index (NOT OPTICS, I SWEAR)
 	int m_mirror_index = 0;
 	/// list of mirrors to use. Mirror has the url base
@@ -59,8 +62,15 @@ public
 slots:
 	virtual void start();
 
+private
+slots:
+	void unpackFinished(QString md5sum);
+	void unpackFailed(QString reason);
+
 private:
-	void decompressAndInstall();
+	void startUnpacking();
+	void discardStream();
+	void discardReply();
 	void failAndTryNextMirror();
 	void updateUrl();
 };
@@ -0,0 +1,250 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ForgeXzUnpacker.h"
+
+#include <QSaveFile>
+#include <QMutexLocker>
+#include <stdexcept>
+
+#include "xz.h"
+#include "unpack200.h"
+#include "logger/QsLog.h"
+
+void ForgeXzStream::feed(const QByteArray &data)
+{
+	if (data.isEmpty())
+		return;
+	QMutexLocker locker(&m_lock);
+	m_chunks.enqueue(data);
+	m_dataAvailable.wakeAll();
+}
+
+void ForgeXzStream::finish()
+{
+	QMutexLocker locker(&m_lock);
+	m_finished = true;
+	m_dataAvailable.wakeAll();
+}
+
+void ForgeXzStream::abort()
+{
+	QMutexLocker locker(&m_lock);
+	m_aborted = true;
+	m_dataAvailable.wakeAll();
+}
+
+qint64 ForgeXzStream::read(char *buf, qint64 maxlen)
+{
+	QMutexLocker locker(&m_lock);
+	while (m_chunks.isEmpty() && !m_finished && !m_aborted)
+	{
+		m_dataAvailable.wait(&m_lock);
+	}
+	if (m_aborted)
+		return -1;
+	qint64 numread = 0;
+	while (numread < maxlen && !m_chunks.isEmpty())
+	{
+		const QByteArray &chunk = m_chunks.head();
+		qint64 amount = qMin(maxlen - numread, qint64(chunk.size() - m_chunk_pos));
+		memcpy(buf + numread, chunk.constData() + m_chunk_pos, amount);
+		numread += amount;
+		m_chunk_pos += amount;
+		if (m_chunk_pos == chunk.size())
+		{
+			m_chunks.dequeue();
+			m_chunk_pos = 0;
+		}
+	}
+	return numread;
+}
+
+namespace
+{
+const size_t buffer_size = 8196;
+
+// pulls .xz data from the stream and hands out the decoded bytes
+class XzStreamDecoder
+{
+public:
+	explicit XzStreamDecoder(ForgeXzStreamPtr stream) : m_stream(stream)
+	{
+		m_state = xz_dec_init(XZ_DYNALLOC, 1 << 26);
+		m_buf.in = m_in;
+		m_buf.in_pos = 0;
+		m_buf.in_size = 0;
+	}
+	~XzStreamDecoder()
+	{
+		if (m_state)
+			xz_dec_end(m_state);
+	}
+	bool isValid()
+	{
+		return m_state != nullptr;
+	}
+	// behaves like unpack_200_reader. Throws on errors, that aborts the unpacking.
+	int64_t read(void *buf, int64_t maxlen)
+	{
+		if (m_ended)
+			return 0;
+		m_buf.out = (uint8_t *)buf;
+		m_buf.out_pos = 0;
+		m_buf.out_size = maxlen;
+		while (m_buf.out_pos == 0)
+		{
+			if (m_buf.in_pos == m_buf.in_size)
+			{
+				qint64 numread = m_stream->read((char *)m_in, sizeof(m_in));
+				if (numread < 0)
+					throw std::runtime_error("Download aborted");
+				m_buf.in_size = numread;
+				m_buf.in_pos = 0;
+			}
+
+			switch (xz_dec_run(m_state, &m_buf))
+			{
+			case XZ_OK:
+				continue;
+
+			case XZ_UNSUPPORTED_CHECK:
+				// unsupported check. this is OK, but we should log this
+				continue;
+
+			case XZ_STREAM_END:
+				m_ended = true;
+				return m_buf.out_pos;
+
+			case XZ_MEM_ERROR:
+				throw std::runtime_error("Memory allocation failed");
+
+			case XZ_MEMLIMIT_ERROR:
+				throw std::runtime_error("Memory usage limit reached");
+
+			case XZ_FORMAT_ERROR:
+				throw std::runtime_error("Not a .xz file");
+
+			case XZ_OPTIONS_ERROR:
+				throw std::runtime_error("Unsupported options in the .xz headers");
+
+			case XZ_DATA_ERROR:
+			case XZ_BUF_ERROR:
+				throw std::runtime_error("File is corrupt");
+
+			default:
+				throw std::runtime_error("Bug!");
+			}
+		}
+		return m_buf.out_pos;
+	}
+
+private:
+	ForgeXzStreamPtr m_stream;
+	struct xz_dec *m_state = nullptr;
+	struct xz_buf m_buf;
+	uint8_t m_in[buffer_size];
+	bool m_ended = false;
+};
+}
+
+ForgeXzUnpacker::ForgeXzUnpacker(ForgeXzStreamPtr stream, QString target_path,
+								 StreamHasher hasher)
+	: m_stream(stream), m_target_path(target_path), m_hasher(hasher)
+{
+}
+
+QThreadPool *ForgeXzUnpacker::pool()
+{
+	// the CRC tables are global, fill them before any worker can use them
+	static bool crc_tables_ready = false;
+	if (!crc_tables_ready)
+	{
+		xz_crc32_init();
+		xz_crc64_init();
+		crc_tables_ready = true;
+	}
+	// default maximum thread count is the number of cores
+	static QThreadPool unpackPool;
+	return &unpackPool;
+}
+
+void ForgeXzUnpacker::run()
+{
+	QString reason;
+	if (!unpack(reason))
+	{
+		emit m_stream->unpackFailed(reason);
+		return;
+	}
+
+	/*
+	 * Forge checksums describe the jar their own unpacker made. Ours doesn't have to produce
+	 * the exact same bytes (the entries get deflated again), so a mismatch isn't fatal here.
+	 */
+	QString hashError;
+	if (!m_hasher.verify(hashError))
+	{
+		QLOG_WARN() << "Unpacked" << m_target_path << "doesn't match its checksums:" << hashError;
+	}
+	emit m_stream->unpacked(m_hasher.result(QCryptographicHash::Md5));
+}
+
+bool ForgeXzUnpacker::unpack(QString &reason)
+{
+	XzStreamDecoder decoder(m_stream);
+	if (!decoder.isValid())
+	{
+		reason = "Memory allocation failed";
+		return false;
+	}
+
+	// the jar is written next to the target and only replaces it when everything went well
+	QSaveFile output(m_target_path);
+	if (!output.open(QIODevice::WriteOnly))
+	{
+		reason = "Error opening " + m_target_path;
+		return false;
+	}
+
+	// the jar gets hashed on its way to the disk, so it doesn't have to be read back
+	m_hasher.enable(QCryptographicHash::Md5);
+	m_hasher.reset();
+	auto reader = [&decoder](void *buf, int64_t maxlen)
+	{ return decoder.read(buf, maxlen); };
+	auto writer = [this, &output](const void *buf, int64_t len)
+	{
+		if (output.write((const char *)buf, len) != len)
+			throw std::runtime_error("Write failed");
+		m_hasher.addData((const char *)buf, len);
+	};
+	try
+	{
+		unpack_200(reader, writer);
+	}
+	catch (std::runtime_error &err)
+	{
+		output.cancelWriting();
+		reason = QString("Error unpacking %1 : %2").arg(m_target_path, err.what());
+		return false;
+	}
+
+	if (!output.commit())
+	{
+		reason = "Failed to commit changes to " + m_target_path;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,87 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QByteArray>
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+#include <memory>
+#include "logic/net/StreamHasher.h"
+
+/**
+ * Byte pipe between a network reply and a ForgeXzUnpacker.
+ *
+ * The downloading side feeds data as it arrives, the unpacking side blocks in read() until
+ * there is something to process. The result of the unpacking is reported through the signals.
+ */
+class ForgeXzStream : public QObject
+{
+	Q_OBJECT
+public:
+	/// append received data
+	void feed(const QByteArray &data);
+	/// mark the end of the data
+	void finish();
+	/// make the reading side give up
+	void abort();
+
+	/**
+	 * Read up to maxlen bytes into buf, blocking until some data is available.
+	 * Returns the number of bytes read, 0 at the end of data and -1 when aborted.
+	 */
+	qint64 read(char *buf, qint64 maxlen);
+
+signals:
+	void unpacked(QString md5sum);
+	void unpackFailed(QString reason);
+
+private:
+	QMutex m_lock;
+	QWaitCondition m_dataAvailable;
+	QQueue<QByteArray> m_chunks;
+	int m_chunk_pos = 0;
+	bool m_finished = false;
+	bool m_aborted = false;
+};
+typedef std::shared_ptr<ForgeXzStream> ForgeXzStreamPtr;
+
+/**
+ * Turns a .pack.xz stream into a jar: xz decoding feeds unpack200 directly, which writes
+ * the target file. The jar is hashed as it is written. Runs on the forge unpacking pool.
+ */
+class ForgeXzUnpacker : public QRunnable
+{
+public:
+	ForgeXzUnpacker(ForgeXzStreamPtr stream, QString target_path, StreamHasher hasher);
+	virtual ~ForgeXzUnpacker(){};
+	virtual void run();
+
+	/// the thread pool all unpacking runs on. One thread per core.
+	static QThreadPool *pool();
+
+private:
+	bool unpack(QString &reason);
+
+private:
+	ForgeXzStreamPtr m_stream;
+	QString m_target_path;
+	/// hashes the unpacked jar, has the checksums it should match
+	StreamHasher m_hasher;
+};
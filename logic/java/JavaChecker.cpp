@@ -1,4 +1,5 @@
 #include "JavaChecker.h"
+#include "JavaProbeCache.h"
 #include "MultiMC.h"
 #include <pathutils.h>
 #include <QFile>
@@ -12,6 +13,15 @@ JavaChecker::JavaChecker(QObject *parent) : QObject(parent)
 
 void JavaChecker::performCheck()
 {
+	if (useCache && MMC->javaProbeCache()->lookup(path, m_cachedResult))
+	{
+		QLOG_DEBUG() << "Java" << path << "didn't change, using the cached probe result";
+		m_cachedResult.id = id;
+		// callers expect the result after this returns
+		QTimer::singleShot(0, this, SLOT(cachedResultReady()));
+		return;
+	}
+
 	QString checkerJar = PathCombine(MMC->bin(), "jars", "JavaCheck.jar");
 
 	QStringList args = {"-jar", checkerJar};
@@ -92,10 +102,17 @@ void JavaChecker::finished(int exitcode, QProcess::ExitStatus status)
 	result.mojangPlatform = is_64 ? "64" : "32";
 	result.realPlatform = os_arch;
 	result.javaVersion = java_version;
+	result.realPath = JavaProbeCache::resolve(path);
 	QLOG_DEBUG() << "Java checker succeeded.";
+	MMC->javaProbeCache()->insert(result);
 	emit checkFinished(result);
 }
 
+void JavaChecker::cachedResultReady()
+{
+	emit checkFinished(m_cachedResult);
+}
+
 void JavaChecker::error(QProcess::ProcessError err)
 {
 	if(err == QProcess::FailedToStart)
@@ -12,6 +12,8 @@ struct JavaCheckResult
 	QString mojangPlatform;
 	QString realPlatform;
 	QString javaVersion;
+	/// the file that was run for path
+	QString realPath;
 	bool valid = false;
 	bool is_64bit = false;
 	int id;
@@ -28,12 +30,18 @@ public:
 
 	QString path;
 	int id;
+	/// take the result from the probe cache if the java didn't change, instead of running it
+	bool useCache = false;
 
 signals:
 	void checkFinished(JavaCheckResult result);
 private:
 	QProcessPtr process;
 	QTimer killTimer;
+	JavaCheckResult m_cachedResult;
+private
+slots:
+	void cachedResultReady();
 public
 slots:
 	void timeout();
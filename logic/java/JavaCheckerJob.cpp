@@ -27,10 +27,25 @@ void JavaCheckerJob::partFinished(JavaCheckResult result)
 	emit progress(num_finished, javacheckers.size());
 
 	javaresults.replace(result.id, result);
+	m_active--;
 
 	if (num_finished == javacheckers.size())
 	{
 		emit finished(javaresults);
+		return;
+	}
+	startMore();
+}
+
+void JavaCheckerJob::startMore()
+{
+	while (m_active < m_max_active && m_next < javacheckers.size())
+	{
+		auto checker = javacheckers[m_next++];
+		m_active++;
+		connect(checker.get(), SIGNAL(checkFinished(JavaCheckResult)),
+				SLOT(partFinished(JavaCheckResult)));
+		checker->performCheck();
 	}
 }
 
@@ -38,10 +53,9 @@ void JavaCheckerJob::start()
 {
 	QLOG_INFO() << m_job_name.toLocal8Bit() << " started.";
 	m_running = true;
-	for (auto iter : javacheckers)
+	for (int i = 0; i < javacheckers.size(); i++)
 	{
 		javaresults.append(JavaCheckResult());
-		connect(iter.get(), SIGNAL(checkFinished(JavaCheckResult)), SLOT(partFinished(JavaCheckResult)));
-		iter->performCheck();
 	}
+	startMore();
 }
@@ -27,19 +27,19 @@ class JavaCheckerJob : public ProgressProvider
 {
 	Q_OBJECT
 public:
-	explicit JavaCheckerJob(QString job_name) : ProgressProvider(), m_job_name(job_name) {};
+	explicit JavaCheckerJob(QString job_name)
+		: ProgressProvider(), m_job_name(job_name), m_max_active(qMax(QThread::idealThreadCount(), 1)) {};
 
 	bool addJavaCheckerAction(JavaCheckerPtr base)
 	{
 		javacheckers.append(base);
 		total_progress++;
-		// if this is already running, the action needs to be started right away!
+		// if this is already running, the action needs to be queued right away!
 		if (isRunning())
 		{
 			emit progress(current_progress, total_progress);
-			connect(base.get(), SIGNAL(checkFinished(JavaCheckResult)), SLOT(partFinished(JavaCheckResult)));
-
-			base->performCheck();
+			javaresults.append(JavaCheckResult());
+			startMore();
 		}
 		return true;
 	}
@@ -77,6 +77,10 @@ private
 slots:
 	void partFinished(JavaCheckResult result);
 
+private:
+	/// start queued checks until the limit is reached
+	void startMore();
+
 private:
 	QString m_job_name;
 	QList<JavaCheckerPtr> javacheckers;
@@ -85,4 +89,10 @@ private:
 	qint64 total_progress = 0;
 	int num_finished = 0;
 	bool m_running = false;
+	/// index of the first check that wasn't started yet
+	int m_next = 0;
+	/// checks started and not finished
+	int m_active = 0;
+	/// each check is a JVM, running more at once than there are cores only slows them all
+	int m_max_active;
 };
@@ -0,0 +1,134 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "JavaProbeCache.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QStandardPaths>
+#include "logger/QsLog.h"
+
+static const quint32 cacheMagic = 0x4d4d4a50; // "MMJP"
+static const quint32 cacheVersion = 1;
+
+JavaProbeCache::JavaProbeCache(QString cache_path) : m_cache_path(cache_path)
+{
+}
+
+void JavaProbeCache::load()
+{
+	if (m_loaded)
+		return;
+	m_loaded = true;
+	m_entries.clear();
+	QFile file(m_cache_path);
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+	QDataStream in(&file);
+	quint32 magic, version, count;
+	in >> magic >> version >> count;
+	if (in.status() != QDataStream::Ok || magic != cacheMagic || version != cacheVersion)
+		return;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		QString path;
+		Entry entry;
+		in >> path >> entry.realPath >> entry.size >> entry.mtime >> entry.mojangPlatform >>
+			entry.realPlatform >> entry.javaVersion >> entry.is_64bit;
+		m_entries.insert(path, entry);
+	}
+	if (in.status() != QDataStream::Ok)
+	{
+		QLOG_WARN() << "Java probe cache" << m_cache_path << "is damaged, java will be probed again";
+		m_entries.clear();
+	}
+}
+
+void JavaProbeCache::save()
+{
+	QSaveFile file(m_cache_path);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		QLOG_ERROR() << "Failed to save java probe cache" << m_cache_path;
+		return;
+	}
+	QDataStream out(&file);
+	out << cacheMagic << cacheVersion << quint32(m_entries.size());
+	for (auto iter = m_entries.begin(); iter != m_entries.end(); iter++)
+	{
+		const Entry &entry = iter.value();
+		out << iter.key() << entry.realPath << entry.size << entry.mtime << entry.mojangPlatform
+			<< entry.realPlatform << entry.javaVersion << entry.is_64bit;
+	}
+	file.commit();
+}
+
+bool JavaProbeCache::lookup(const QString &path, JavaCheckResult &result)
+{
+	load();
+	auto iter = m_entries.constFind(path);
+	if (iter == m_entries.constEnd())
+		return false;
+	// java is often a symlink that gets pointed somewhere else on updates
+	QFileInfo file(resolve(path));
+	const Entry &entry = iter.value();
+	if (file.filePath().isEmpty() || file.filePath() != entry.realPath || file.size() != entry.size ||
+		file.lastModified().toMSecsSinceEpoch() != entry.mtime)
+		return false;
+
+	result.path = path;
+	result.realPath = entry.realPath;
+	result.mojangPlatform = entry.mojangPlatform;
+	result.realPlatform = entry.realPlatform;
+	result.javaVersion = entry.javaVersion;
+	result.is_64bit = entry.is_64bit;
+	result.valid = true;
+	return true;
+}
+
+void JavaProbeCache::insert(const JavaCheckResult &result)
+{
+	// without knowing the file, there is no telling when it changes
+	if (!result.valid || result.realPath.isEmpty())
+		return;
+	load();
+	QFileInfo file(result.realPath);
+	Entry entry;
+	entry.realPath = result.realPath;
+	entry.size = file.size();
+	entry.mtime = file.lastModified().toMSecsSinceEpoch();
+	entry.mojangPlatform = result.mojangPlatform;
+	entry.realPlatform = result.realPlatform;
+	entry.javaVersion = result.javaVersion;
+	entry.is_64bit = result.is_64bit;
+	m_entries.insert(result.path, entry);
+	save();
+}
+
+QString JavaProbeCache::resolve(const QString &path)
+{
+	QFileInfo file(path);
+	// a plain name, like the default "java", is looked up in PATH
+	if (!path.contains('/') && !path.contains('\\'))
+	{
+		QString found = QStandardPaths::findExecutable(path);
+		if (!found.isEmpty())
+			file.setFile(found);
+	}
+	return file.canonicalFilePath();
+}
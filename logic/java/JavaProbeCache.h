@@ -0,0 +1,63 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <QString>
+#include <QHash>
+
+#include "JavaChecker.h"
+
+/**
+ * Remembers what probing a java binary found out, so it doesn't have to be started again.
+ *
+ * Entries are keyed on the path that was probed. They are used while the path still
+ * resolves to the same file, with the same size and modification time. Only successful
+ * probes are kept, a failure may be temporary.
+ */
+class JavaProbeCache
+{
+public:
+	explicit JavaProbeCache(QString cache_path);
+
+	void load();
+	void save();
+
+	/// fill in the result for the path, if it is known and still valid. false if it isn't.
+	bool lookup(const QString &path, JavaCheckResult &result);
+
+	/// remember a probe result and save the cache
+	void insert(const JavaCheckResult &result);
+
+	/// the file a java path really runs, with symlinks resolved and PATH searched
+	static QString resolve(const QString &path);
+
+private:
+	struct Entry
+	{
+		/// the file the path resolved to
+		QString realPath;
+		qint64 size = -1;
+		qint64 mtime = 0;
+		QString mojangPlatform;
+		QString realPlatform;
+		QString javaVersion;
+		bool is_64bit = false;
+	};
+	QString m_cache_path;
+	QHash<QString, Entry> m_entries;
+	bool m_loaded = false;
+};
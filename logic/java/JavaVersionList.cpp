@@ -190,6 +190,7 @@ void JavaListLoadTask::executeTask()
 		auto candidate_checker = new JavaChecker();
 		candidate_checker->path = candidate;
 		candidate_checker->id = id;
+		candidate_checker->useCache = true;
 		m_job->addJavaCheckerAction(JavaCheckerPtr(candidate_checker));
 
 		id++;
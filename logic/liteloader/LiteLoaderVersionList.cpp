@@ -103,6 +103,7 @@ void LLListLoadTask::executeTask()
 {
 	setStatus(tr("Loading LiteLoader version list..."));
 	auto job = new NetJob("Version index");
+	job->setPriority(Priority_Interactive);
 	// we do not care if the version is stale or not.
 	auto liteloaderEntry = MMC->metacache()->resolveEntry("liteloader", "versions.json");
 
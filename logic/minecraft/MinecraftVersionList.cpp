@@ -409,6 +409,7 @@ void MCVListVersionUpdateTask::executeTask()
 	QString urlstr = "http://" + URLConstants::AWS_DOWNLOAD_VERSIONS + versionToUpdate + "/" +
 					 versionToUpdate + ".json";
 	auto job = new NetJob("Version index");
+	job->setPriority(Priority_Interactive);
 	job->addNetAction(ByteArrayDownload::make(QUrl(urlstr)));
 	specificVersionDownloadJob.reset(job);
 	connect(specificVersionDownloadJob.get(), SIGNAL(succeeded()), SLOT(json_downloaded()));
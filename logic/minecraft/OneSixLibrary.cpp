@@ -29,6 +29,7 @@ OneSixLibrary::OneSixLibrary(RawLibraryPtr base)
 	m_base_url = base->m_base_url;
 	m_hint = base->m_hint;
 	m_absolute_url = base->m_absolute_url;
+	m_checksums = base->m_checksums;
 	extract_excludes = base->extract_excludes;
 	m_native_classifiers = base->m_native_classifiers;
 	m_rules = base->m_rules;
@@ -33,6 +33,13 @@ RawLibraryPtr RawLibrary::fromJson(const QJsonObject &libObj, const QString &fil
 	readString("MMC-hint", out->m_hint);
 	readString("MMC-absulute_url", out->m_absolute_url);
 	readString("MMC-absoluteUrl", out->m_absolute_url);
+	if (libObj.contains("checksums"))
+	{
+		for (auto checksumVal : ensureArray(libObj.value("checksums")))
+		{
+			out->m_checksums.append(ensureString(checksumVal));
+		}
+	}
 	if (libObj.contains("extract"))
 	{
 		out->applyExcludes = true;
@@ -150,6 +157,8 @@ QJsonObject RawLibrary::toJson() const
 		libRoot.insert("MMC-absoluteUrl", m_absolute_url);
 	if (m_hint.size())
 		libRoot.insert("MMC-hint", m_hint);
+	if (m_checksums.size())
+		libRoot.insert("checksums", QJsonArray::fromStringList(m_checksums));
 	if (m_base_url != "http://" + URLConstants::AWS_DOWNLOAD_LIBRARIES &&
 		m_base_url != "https://" + URLConstants::AWS_DOWNLOAD_LIBRARIES &&
 		m_base_url != "https://" + URLConstants::LIBRARY_BASE && !m_base_url.isEmpty())
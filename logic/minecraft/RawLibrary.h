@@ -100,6 +100,16 @@ public: /* methods */
 		return m_hint;
 	}
 
+	void setChecksums(const QStringList &checksums)
+	{
+		m_checksums = checksums;
+	}
+
+	QStringList checksums() const
+	{
+		return m_checksums;
+	}
+
 	/// Set the load rules
 	void setRules(QList<std::shared_ptr<Rule>> rules)
 	{
@@ -136,6 +146,9 @@ public: /* data */
 	/// type hint - modifies how the library is treated
 	QString m_hint;
 
+	/// SHA-1 checksums the library file may have. Any of them is fine (from Forge).
+	QStringList m_checksums;
+
 	/// true if the library had an extract/excludes section (even empty)
 	bool applyExcludes = false;
 
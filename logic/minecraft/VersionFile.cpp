@@ -396,6 +396,10 @@ void VersionFile::applyTo(InstanceVersion *version)
 				{
 					existingLibrary->setAbsoluteUrl(addedLibrary->m_absolute_url);
 				}
+				if (!addedLibrary->m_checksums.isEmpty())
+				{
+					existingLibrary->setChecksums(addedLibrary->m_checksums);
+				}
 				if (addedLibrary->applyExcludes)
 				{
 					existingLibrary->extract_excludes = addedLibrary->extract_excludes;
@@ -0,0 +1,233 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MultiMC.h"
+#include "BatchDownload.h"
+#include <pathutils.h>
+#include "logger/QsLog.h"
+
+static qint64 fileWeight(qint64 size)
+{
+	return size > 0 ? size : 1;
+}
+
+BatchDownload::BatchDownload(QUrl base_url, int window)
+	: NetAction(), m_base_url(base_url), m_window(qMax(1, window))
+{
+	m_url = base_url;
+	m_status = Job_NotStarted;
+	m_total_progress = 0;
+}
+
+BatchDownload::~BatchDownload()
+{
+	for (auto reply : m_transfers.keys())
+	{
+		disconnect(reply, 0, this, 0);
+		reply->abort();
+		reply->deleteLater();
+	}
+}
+
+void BatchDownload::addFile(QString relative_path, QString target_path, QString sha1,
+							qint64 size)
+{
+	File file;
+	file.relative_path = relative_path;
+	file.target_path = target_path;
+	file.sha1 = sha1;
+	file.size = size;
+	m_files.append(file);
+	m_total_progress += fileWeight(size);
+}
+
+QStringList BatchDownload::failedFiles() const
+{
+	QStringList failed;
+	for (auto &file : m_files)
+	{
+		if (file.failed)
+			failed.append(m_base_url.resolved(QUrl(file.relative_path)).toString());
+	}
+	return failed;
+}
+
+void BatchDownload::start()
+{
+	m_status = Job_InProgress;
+	m_queue.clear();
+	m_failed_count = 0;
+	m_done_progress = 0;
+	for (int i = 0; i < m_files.size(); i++)
+	{
+		auto &file = m_files[i];
+		file.failed = false;
+		if (file.done)
+			m_done_progress += fileWeight(file.size);
+		else
+			m_queue.enqueue(i);
+	}
+	QLOG_INFO() << "Downloading" << m_queue.size() << "files from" << m_base_url.toString();
+	updateProgress();
+	fillWindow();
+}
+
+void BatchDownload::fillWindow()
+{
+	while (m_transfers.size() < m_window && !m_queue.isEmpty())
+	{
+		startFile(m_queue.dequeue());
+	}
+	if (!m_transfers.isEmpty())
+		return;
+
+	// nothing left to do
+	if (m_failed_count)
+	{
+		QLOG_ERROR() << m_failed_count << "files from" << m_base_url.toString() << "failed";
+		m_status = Job_Failed;
+		emit failed(m_index_within_job);
+	}
+	else
+	{
+		m_status = Job_Finished;
+		emit succeeded(m_index_within_job);
+	}
+}
+
+void BatchDownload::startFile(int index)
+{
+	auto &file = m_files[index];
+	Transfer transfer;
+	transfer.index = index;
+	transfer.output = std::make_shared<QSaveFile>(file.target_path);
+	if (!ensureFilePathExists(file.target_path) ||
+		!transfer.output->open(QIODevice::WriteOnly))
+	{
+		QLOG_ERROR() << "Could not open " + file.target_path + " for writing";
+		file.failed = true;
+		m_failed_count++;
+		return;
+	}
+	transfer.hasher.expect(QCryptographicHash::Sha1, {file.sha1});
+
+	QNetworkRequest request(m_base_url.resolved(QUrl(file.relative_path)));
+	request.setHeader(QNetworkRequest::UserAgentHeader, "MultiMC/5.0 (Batch)");
+	// the files are small, sending the next requests early hides the round trips
+	request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+
+	auto worker = MMC->qnam();
+	QNetworkReply *rep = worker->get(request);
+	m_transfers.insert(rep, transfer);
+	connect(rep, SIGNAL(downloadProgress(qint64, qint64)),
+			SLOT(downloadProgress(qint64, qint64)));
+	connect(rep, SIGNAL(finished()), SLOT(downloadFinished()));
+	connect(rep, SIGNAL(error(QNetworkReply::NetworkError)),
+			SLOT(downloadError(QNetworkReply::NetworkError)));
+	connect(rep, SIGNAL(readyRead()), SLOT(downloadReadyRead()));
+}
+
+void BatchDownload::downloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+	auto iter = m_transfers.find(qobject_cast<QNetworkReply *>(sender()));
+	if (iter == m_transfers.end())
+		return;
+	iter.value().received = bytesReceived;
+	updateProgress();
+}
+
+void BatchDownload::downloadError(QNetworkReply::NetworkError error)
+{
+	auto reply = qobject_cast<QNetworkReply *>(sender());
+	auto iter = m_transfers.find(reply);
+	if (iter == m_transfers.end())
+		return;
+	QLOG_ERROR() << "Failed " << reply->url().toString() << " with reason " << error;
+	iter.value().failed = true;
+}
+
+void BatchDownload::downloadReadyRead()
+{
+	auto iter = m_transfers.find(qobject_cast<QNetworkReply *>(sender()));
+	if (iter == m_transfers.end())
+		return;
+	auto &transfer = iter.value();
+	QByteArray ba = iter.key()->readAll();
+	transfer.hasher.addData(ba);
+	if (transfer.output->write(ba) != ba.size())
+	{
+		QLOG_ERROR() << "Failed writing into " + m_files[transfer.index].target_path;
+		transfer.failed = true;
+		iter.key()->abort();
+	}
+}
+
+void BatchDownload::downloadFinished()
+{
+	auto reply = qobject_cast<QNetworkReply *>(sender());
+	auto iter = m_transfers.find(reply);
+	if (iter == m_transfers.end())
+		return;
+	auto &transfer = iter.value();
+	bool ok = !transfer.failed;
+	if (ok)
+	{
+		QString hashError;
+		if (!transfer.hasher.verify(hashError))
+		{
+			QLOG_ERROR() << "Rejecting" << reply->url().toString() << ":" << hashError;
+			ok = false;
+		}
+	}
+	if (ok && !transfer.output->commit())
+	{
+		QLOG_ERROR() << "Failed to commit changes to "
+					 << m_files[transfer.index].target_path;
+		ok = false;
+	}
+	fileDone(reply, ok);
+}
+
+void BatchDownload::fileDone(QNetworkReply *reply, bool ok)
+{
+	Transfer transfer = m_transfers.take(reply);
+	reply->deleteLater();
+	auto &file = m_files[transfer.index];
+	if (ok)
+	{
+		file.done = true;
+		m_done_progress += fileWeight(file.size);
+	}
+	else
+	{
+		transfer.output->cancelWriting();
+		file.failed = true;
+		m_failed_count++;
+	}
+	updateProgress();
+	fillWindow();
+}
+
+void BatchDownload::updateProgress()
+{
+	m_progress = m_done_progress;
+	for (auto &transfer : m_transfers)
+	{
+		// don't go over the file's share if the size we got was wrong
+		qint64 weight = fileWeight(m_files[transfer.index].size);
+		m_progress += qMin(transfer.received, weight);
+	}
+	emit progress(m_index_within_job, m_progress, m_total_progress);
+}
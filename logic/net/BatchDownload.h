@@ -0,0 +1,107 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "NetAction.h"
+#include <QSaveFile>
+#include <QHash>
+#include <QQueue>
+
+typedef std::shared_ptr<class BatchDownload> BatchDownloadPtr;
+
+/**
+ * Downloads many small files from one host as a single action.
+ *
+ * Keeps a bounded window of requests in flight, with HTTP pipelining allowed, so the few
+ * kept-alive connections to the host stay busy instead of paying the request overhead per
+ * file. Every file is streamed straight into its target and checked against its SHA-1.
+ *
+ * Files that fail don't stop the others. The action fails at the end if any did, and only
+ * the failed files get fetched again when it is restarted.
+ */
+class BatchDownload : public NetAction
+{
+	Q_OBJECT
+public:
+	explicit BatchDownload(QUrl base_url, int window = 24);
+	static BatchDownloadPtr make(QUrl base_url, int window = 24)
+	{
+		return BatchDownloadPtr(new BatchDownload(base_url, window));
+	}
+	virtual ~BatchDownload();
+
+	/**
+	 * Add a file. The path is relative to the base URL.
+	 * The SHA-1 and the size are optional, a size of -1 means unknown.
+	 */
+	void addFile(QString relative_path, QString target_path, QString sha1 = QString(),
+				 qint64 size = -1);
+
+	int fileCount() const
+	{
+		return m_files.size();
+	}
+
+	/// URLs of the files that failed in the last run
+	QStringList failedFiles() const;
+
+protected
+slots:
+	virtual void downloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+	virtual void downloadError(QNetworkReply::NetworkError error);
+	virtual void downloadFinished();
+	virtual void downloadReadyRead();
+
+public
+slots:
+	virtual void start();
+
+private:
+	void fillWindow();
+	void startFile(int index);
+	void fileDone(QNetworkReply *reply, bool ok);
+	void updateProgress();
+
+private:
+	struct File
+	{
+		QString relative_path;
+		QString target_path;
+		QString sha1;
+		qint64 size = -1;
+		bool done = false;
+		bool failed = false;
+	};
+	struct Transfer
+	{
+		int index = 0;
+		std::shared_ptr<QSaveFile> output;
+		StreamHasher hasher;
+		qint64 received = 0;
+		bool failed = false;
+	};
+
+	QUrl m_base_url;
+	int m_window;
+	QList<File> m_files;
+	/// indexes of the files waiting for a request
+	QQueue<int> m_queue;
+	/// requests in flight
+	QHash<QNetworkReply *, Transfer> m_transfers;
+	/// progress of the files that are done
+	qint64 m_done_progress = 0;
+	int m_failed_count = 0;
+};
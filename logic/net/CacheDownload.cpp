@@ -23,12 +23,14 @@
 #include "logger/QsLog.h"
 
 CacheDownload::CacheDownload(QUrl url, MetaEntryPtr entry)
-	: NetAction(), md5sum(QCryptographicHash::Md5)
+	: NetAction(), m_output_file(entry->getFullPath())
 {
 	m_url = url;
 	m_entry = entry;
 	m_target_path = entry->getFullPath();
 	m_status = Job_NotStarted;
+	// the cache wants the MD5 of what it stores
+	m_hasher.enable(QCryptographicHash::Md5);
 }
 
 void CacheDownload::start()
@@ -40,8 +42,7 @@ void CacheDownload::start()
 		emit succeeded(m_index_within_job);
 		return;
 	}
-	// create a new save file
-	m_output_file.reset(new QSaveFile(m_target_path));
+	wroteAnyData = false;
 
 	// if there already is a file and md5 checking is in effect and it can be opened
 	if (!ensureFilePathExists(m_target_path))
@@ -51,15 +52,10 @@ void CacheDownload::start()
 		emit failed(m_index_within_job);
 		return;
 	}
-	if (!m_output_file->open(QIODevice::WriteOnly))
-	{
-		QLOG_ERROR() << "Could not open " + m_target_path + " for writing";
-		m_status = Job_Failed;
-		emit failed(m_index_within_job);
-		return;
-	}
 	QLOG_INFO() << "Downloading " << m_url.toString();
 	QNetworkRequest request(m_url);
+	// continues where a failed attempt stopped, if it can
+	m_output_file.prepare(request, m_hasher);
 
 	// check file consistency first.
 	QFile current(m_target_path);
@@ -88,9 +84,11 @@ void CacheDownload::start()
 
 void CacheDownload::downloadProgress(qint64 bytesReceived, qint64 bytesTotal)
 {
-	m_total_progress = bytesTotal;
-	m_progress = bytesReceived;
-	emit progress(m_index_within_job, bytesReceived, bytesTotal);
+	// count what was already on disk before this request
+	qint64 offset = m_output_file.offset();
+	m_total_progress = bytesTotal < 0 ? bytesTotal : offset + bytesTotal;
+	m_progress = offset + bytesReceived;
+	emit progress(m_index_within_job, m_progress, m_total_progress);
 }
 
 void CacheDownload::downloadError(QNetworkReply::NetworkError error)
@@ -125,10 +123,18 @@ void CacheDownload::downloadFinished()
 		}
 	}
 
+	// the data kept from the last attempt already was all of it
+	if (m_status == Job_Failed && !m_output_file.isWriting() &&
+		m_output_file.resumesComplete(m_reply.get()))
+	{
+		m_status = Job_InProgress;
+		wroteAnyData = true;
+	}
+
 	// if the download succeeded
 	if (m_status == Job_Failed)
 	{
-		m_output_file->cancelWriting();
+		m_output_file.keep(m_reply.get());
 		m_reply.reset();
 		emit failed(m_index_within_job);
 		return;
@@ -137,16 +143,27 @@ void CacheDownload::downloadFinished()
 	// if we wrote any data to the save file, we try to commit the data to the real file.
 	if (wroteAnyData)
 	{
+		// the data has to be what we asked for, or the old file stays
+		QString hashError;
+		if (!m_hasher.verify(hashError))
+		{
+			QLOG_ERROR() << "Rejecting" << m_url.toString() << ":" << hashError;
+			m_output_file.discard();
+			m_reply.reset();
+			m_status = Job_Failed;
+			emit failed(m_index_within_job);
+			return;
+		}
 		// nothing went wrong...
-		if (m_output_file->commit())
+		if (m_output_file.commit())
 		{
 			m_status = Job_Finished;
-			m_entry->md5sum = md5sum.result().toHex().constData();
+			m_entry->md5sum = m_hasher.result(QCryptographicHash::Md5);
 		}
 		else
 		{
 			QLOG_ERROR() << "Failed to commit changes to " << m_target_path;
-			m_output_file->cancelWriting();
+			m_output_file.discard();
 			m_reply.reset();
 			m_status = Job_Failed;
 			emit failed(m_index_within_job);
@@ -155,12 +172,11 @@ void CacheDownload::downloadFinished()
 	}
 	else
 	{
+		// not modified, or nothing to resume
+		m_output_file.discard();
 		m_status = Job_Finished;
 	}
 
-	// then get rid of the save file
-	m_output_file.reset();
-
 	QFileInfo output_file_info(m_target_path);
 
 	m_entry->etag = m_reply->rawHeader("ETag").constData();
@@ -181,8 +197,22 @@ void CacheDownload::downloadFinished()
 void CacheDownload::downloadReadyRead()
 {
 	QByteArray ba = m_reply->readAll();
-	md5sum.addData(ba);
-	if (m_output_file->write(ba) != ba.size())
+	if (!m_output_file.isWriting())
+	{
+		// redirect and error bodies don't go into the file
+		if (m_status == Job_Failed || !PartialDownload::carriesFile(m_reply.get()))
+			return;
+		if (!m_output_file.begin(m_reply.get(), m_hasher))
+		{
+			// start from scratch next time
+			m_output_file.discard();
+			m_status = Job_Failed;
+			QMetaObject::invokeMethod(m_reply.get(), "abort", Qt::QueuedConnection);
+			return;
+		}
+	}
+	m_hasher.addData(ba);
+	if (!m_output_file.write(ba))
 	{
 		QLOG_ERROR() << "Failed writing into " + m_target_path;
 		m_status = Job_Failed;
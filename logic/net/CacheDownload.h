@@ -17,8 +17,7 @@
 
 #include "NetAction.h"
 #include "HttpMetaCache.h"
-#include <QCryptographicHash>
-#include <QSaveFile>
+#include "PartialDownload.h"
 
 typedef std::shared_ptr<class CacheDownload> CacheDownloadPtr;
 class CacheDownload : public NetAction
@@ -28,11 +27,8 @@ private:
 	MetaEntryPtr m_entry;
 	/// if saving to file, use the one specified in this string
 	QString m_target_path;
-	/// this is the output file, if any
-	std::shared_ptr<QSaveFile> m_output_file;
-	/// the hash-as-you-download
-	QCryptographicHash md5sum;
-
+	/// the data goes here first, and stays there to be resumed if the download fails
+	PartialDownload m_output_file;
 	bool wroteAnyData = false;
 
 public:
@@ -23,6 +23,7 @@
 #include <QSaveFile>
 #include <QDateTime>
 #include <QCryptographicHash>
+#include <QThread>
 
 #include "logger/QsLog.h"
 
@@ -49,48 +50,64 @@ HttpMetaCache::~HttpMetaCache()
 	SaveNow();
 }
 
-MetaEntryPtr HttpMetaCache::getEntry(QString base, QString resource_path)
+HttpMetaCache::EntryMapPtr HttpMetaCache::findBase(const QString &base)
+{
+	QReadLocker locker(&m_bases_lock);
+	return m_entries.value(base);
+}
+
+MetaEntryPtr HttpMetaCache::lookupEntry(const QString &base, const QString &resource_path,
+										MetaEntryPtr &cached)
 {
 	// no base. no base path. can't store
-	if (!m_entries.contains(base))
+	auto map = findBase(base);
+	if (!map)
 	{
 		// TODO: log problem
 		return MetaEntryPtr();
 	}
-	EntryMap &map = m_entries[base];
-	if (map.entry_list.contains(resource_path))
-	{
-		return map.entry_list[resource_path];
-	}
-	return MetaEntryPtr();
+	auto &shard = map->shardFor(resource_path);
+	QReadLocker locker(&shard.lock);
+	cached = shard.entries.value(resource_path);
+	if (!cached)
+		return MetaEntryPtr();
+	// the caller may change it, and the cached one is only changed under the lock
+	return std::make_shared<MetaEntry>(*cached);
+}
+
+MetaEntryPtr HttpMetaCache::getEntry(QString base, QString resource_path)
+{
+	MetaEntryPtr cached;
+	return lookupEntry(base, resource_path, cached);
 }
 
 MetaEntryPtr HttpMetaCache::resolveEntry(QString base, QString resource_path,
 										 QString expected_etag)
 {
-	auto entry = getEntry(base, resource_path);
+	MetaEntryPtr cached;
+	auto entry = lookupEntry(base, resource_path, cached);
 	// it's not present? generate a default stale entry
 	if (!entry)
 	{
 		return staleEntry(base, resource_path);
 	}
 
-	auto &selected_base = m_entries[base];
-	QString real_path = PathCombine(selected_base.base_path, resource_path);
+	auto selected_base = findBase(base);
+	QString real_path = PathCombine(selected_base->base_path, resource_path);
 	QFileInfo finfo(real_path);
 
 	// is the file really there? if not -> stale
 	if (!finfo.isFile() || !finfo.isReadable())
 	{
 		// if the file doesn't exist, we disown the entry
-		selected_base.entry_list.remove(resource_path);
+		removeEntry(cached);
 		return staleEntry(base, resource_path);
 	}
 
 	if (!expected_etag.isEmpty() && expected_etag != entry->etag)
 	{
 		// if the etag doesn't match expected, we disown the entry
-		selected_base.entry_list.remove(resource_path);
+		removeEntry(cached);
 		return staleEntry(base, resource_path);
 	}
 
@@ -98,18 +115,30 @@ MetaEntryPtr HttpMetaCache::resolveEntry(QString base, QString resource_path,
 	qint64 file_last_changed = finfo.lastModified().toUTC().toMSecsSinceEpoch();
 	if (file_last_changed != entry->local_changed_timestamp)
 	{
+		// hash the file as it is read, without loading all of it
 		QFile input(real_path);
-		input.open(QIODevice::ReadOnly);
-		QString md5sum = QCryptographicHash::hash(input.readAll(), QCryptographicHash::Md5)
-							 .toHex()
-							 .constData();
+		QCryptographicHash hash(QCryptographicHash::Md5);
+		if (input.open(QIODevice::ReadOnly))
+			hash.addData(&input);
+		QString md5sum = hash.result().toHex().constData();
 		if (entry->md5sum != md5sum)
 		{
-			selected_base.entry_list.remove(resource_path);
+			removeEntry(cached);
 			return staleEntry(base, resource_path);
 		}
 		// md5sums matched... keep entry and save the new state to file
 		entry->local_changed_timestamp = file_last_changed;
+		{
+			auto &shard = selected_base->shardFor(resource_path);
+			QWriteLocker locker(&shard.lock);
+			// unless somebody else put a newer entry there in the meantime
+			auto iter = shard.entries.find(resource_path);
+			if (iter != shard.entries.end() && iter.value() == cached)
+			{
+				iter.value() = std::make_shared<MetaEntry>(*entry);
+				journalUpdate(shard, entry);
+			}
+		}
 		SaveEventually();
 	}
 
@@ -119,7 +148,8 @@ MetaEntryPtr HttpMetaCache::resolveEntry(QString base, QString resource_path,
 
 bool HttpMetaCache::updateEntry(MetaEntryPtr stale_entry)
 {
-	if (!m_entries.contains(stale_entry->base))
+	auto map = findBase(stale_entry->base);
+	if (!map)
 	{
 		QLOG_ERROR() << "Cannot add entry with unknown base: "
 					 << stale_entry->base.toLocal8Bit();
@@ -130,11 +160,36 @@ bool HttpMetaCache::updateEntry(MetaEntryPtr stale_entry)
 		QLOG_ERROR() << "Cannot add stale entry: " << stale_entry->getFullPath().toLocal8Bit();
 		return false;
 	}
-	m_entries[stale_entry->base].entry_list[stale_entry->path] = stale_entry;
+	{
+		// the caller keeps its entry, and may change it again
+		auto entry = std::make_shared<MetaEntry>(*stale_entry);
+		auto &shard = map->shardFor(entry->path);
+		QWriteLocker locker(&shard.lock);
+		shard.entries[entry->path] = entry;
+		journalUpdate(shard, entry);
+	}
 	SaveEventually();
 	return true;
 }
 
+void HttpMetaCache::removeEntry(MetaEntryPtr cached)
+{
+	auto map = findBase(cached->base);
+	if (!map)
+		return;
+	{
+		auto &shard = map->shardFor(cached->path);
+		QWriteLocker locker(&shard.lock);
+		// somebody else could have put a fresh entry there in the meantime
+		auto iter = shard.entries.find(cached->path);
+		if (iter == shard.entries.end() || iter.value() != cached)
+			return;
+		shard.entries.erase(iter);
+		journalRemove(shard, cached->base, cached->path);
+	}
+	SaveEventually();
+}
+
 MetaEntryPtr HttpMetaCache::staleEntry(QString base, QString resource_path)
 {
 	auto foo = new MetaEntry;
@@ -146,31 +201,205 @@ MetaEntryPtr HttpMetaCache::staleEntry(QString base, QString resource_path)
 
 void HttpMetaCache::addBase(QString base, QString base_root)
 {
+	QWriteLocker locker(&m_bases_lock);
 	// TODO: report error
 	if (m_entries.contains(base))
 		return;
 	// TODO: check if the base path is valid
-	EntryMap foo;
-	foo.base_path = base_root;
+	auto foo = std::make_shared<EntryMap>();
+	foo->base_path = base_root;
 	m_entries[base] = foo;
 }
 
 QString HttpMetaCache::getBasePath(QString base)
 {
-	if (m_entries.contains(base))
+	auto map = findBase(base);
+	if (map)
 	{
-		return m_entries[base].base_path;
+		return map->base_path;
 	}
 	return QString();
 }
 
+/*
+ * The index file is a journal. The first line is a header, then every line is a record,
+ * with tab separated fields:
+ *   U <base> <path> <md5sum> <etag> <local timestamp> <remote timestamp> - add or update
+ *   R <base> <path> - remove
+ * Records are only ever appended. When the file has a lot more records than there are
+ * entries, it gets rewritten with one record per entry.
+ */
+static const QByteArray journalHeader = "MMC_METACACHE 2\n";
+
+static QByteArray escapeField(const QString &field)
+{
+	QByteArray out;
+	QByteArray in = field.toUtf8();
+	out.reserve(in.size());
+	for (char c : in)
+	{
+		switch (c)
+		{
+		case '\\':
+			out.append("\\\\");
+			break;
+		case '\t':
+			out.append("\\t");
+			break;
+		case '\n':
+			out.append("\\n");
+			break;
+		default:
+			out.append(c);
+		}
+	}
+	return out;
+}
+
+static QString unescapeField(const QByteArray &in)
+{
+	QByteArray out;
+	out.reserve(in.size());
+	for (int i = 0; i < in.size(); i++)
+	{
+		char c = in[i];
+		if (c == '\\' && i + 1 < in.size())
+		{
+			char next = in[++i];
+			if (next == 't')
+				c = '\t';
+			else if (next == 'n')
+				c = '\n';
+			else
+				c = next;
+		}
+		out.append(c);
+	}
+	return QString::fromUtf8(out);
+}
+
+static QByteArray updateRecord(MetaEntryPtr entry)
+{
+	QByteArray record = "U\t";
+	record.append(escapeField(entry->base)).append('\t');
+	record.append(escapeField(entry->path)).append('\t');
+	record.append(escapeField(entry->md5sum)).append('\t');
+	record.append(escapeField(entry->etag)).append('\t');
+	record.append(QByteArray::number(entry->local_changed_timestamp)).append('\t');
+	record.append(escapeField(entry->remote_changed_timestamp)).append('\n');
+	return record;
+}
+
+void HttpMetaCache::journalUpdate(EntryShard &shard, MetaEntryPtr entry)
+{
+	shard.pending.append(updateRecord(entry));
+	shard.pending_records++;
+}
+
+void HttpMetaCache::journalRemove(EntryShard &shard, QString base, QString resource_path)
+{
+	QByteArray record = "R\t";
+	record.append(escapeField(base)).append('\t');
+	record.append(escapeField(resource_path)).append('\n');
+	shard.pending.append(record);
+	shard.pending_records++;
+}
+
+// called with the journal lock held
+void HttpMetaCache::collectJournal()
+{
+	// all the records of a path are in the same shard, so their order is kept
+	QReadLocker locker(&m_bases_lock);
+	for (auto map : m_entries)
+	{
+		for (auto &shard : map->shards)
+		{
+			QWriteLocker shardLocker(&shard.lock);
+			m_pending_records.append(shard.pending);
+			m_journal_records += shard.pending_records;
+			shard.pending.clear();
+			shard.pending_records = 0;
+		}
+	}
+}
+
+bool HttpMetaCache::applyJournalRecord(const QByteArray &line)
+{
+	auto fields = line.split('\t');
+	if (fields.size() < 3)
+		return false;
+	QString base = unescapeField(fields[1]);
+	QString path = unescapeField(fields[2]);
+	auto map = findBase(base);
+	if (fields[0] == "R" && fields.size() == 3)
+	{
+		if (map)
+		{
+			auto &shard = map->shardFor(path);
+			QWriteLocker locker(&shard.lock);
+			shard.entries.remove(path);
+		}
+		return true;
+	}
+	if (fields[0] != "U" || fields.size() != 7)
+		return false;
+	// entries of bases we don't know about are dropped
+	if (!map)
+		return true;
+	auto foo = new MetaEntry;
+	foo->base = base;
+	foo->path = path;
+	foo->md5sum = unescapeField(fields[3]);
+	foo->etag = unescapeField(fields[4]);
+	foo->local_changed_timestamp = fields[5].toLongLong();
+	foo->remote_changed_timestamp = unescapeField(fields[6]);
+	// presumed innocent until closer examination
+	foo->stale = false;
+	auto &shard = map->shardFor(path);
+	QWriteLocker locker(&shard.lock);
+	shard.entries[path] = MetaEntryPtr(foo);
+	return true;
+}
+
 void HttpMetaCache::Load()
 {
 	QFile index(m_index_file);
 	if (!index.open(QIODevice::ReadOnly))
 		return;
 
-	QJsonDocument json = QJsonDocument::fromJson(index.readAll());
+	QByteArray header = index.readLine();
+	if (header != journalHeader)
+	{
+		// the old JSON format. Read it and replace it with a journal on the next save.
+		loadJson(header + index.readAll());
+		m_needs_compaction = true;
+		SaveEventually();
+		return;
+	}
+
+	while (!index.atEnd())
+	{
+		QByteArray line = index.readLine();
+		// an unfinished line at the end means we got interrupted while writing it
+		if (!line.endsWith('\n'))
+		{
+			QLOG_WARN() << "Metacache journal ends with an incomplete record.";
+			m_needs_compaction = true;
+			break;
+		}
+		line.chop(1);
+		m_journal_records++;
+		if (!applyJournalRecord(line))
+		{
+			QLOG_WARN() << "Ignoring broken metacache record:" << line;
+			m_needs_compaction = true;
+		}
+	}
+}
+
+void HttpMetaCache::loadJson(const QByteArray &data)
+{
+	QJsonDocument json = QJsonDocument::fromJson(data);
 	if (!json.isObject())
 		return;
 	auto root = json.object();
@@ -192,9 +421,9 @@ void HttpMetaCache::Load()
 			return;
 		auto element_obj = element.toObject();
 		QString base = element_obj.value("base").toString();
-		if (!m_entries.contains(base))
+		auto map = findBase(base);
+		if (!map)
 			continue;
-		auto &entrymap = m_entries[base];
 		auto foo = new MetaEntry;
 		foo->base = base;
 		QString path = foo->path = element_obj.value("path").toString();
@@ -205,49 +434,104 @@ void HttpMetaCache::Load()
 			element_obj.value("remote_changed_timestamp").toString();
 		// presumed innocent until closer examination
 		foo->stale = false;
-		entrymap.entry_list[path] = MetaEntryPtr(foo);
+		auto &shard = map->shardFor(path);
+		QWriteLocker locker(&shard.lock);
+		shard.entries[path] = MetaEntryPtr(foo);
 	}
 }
 
 void HttpMetaCache::SaveEventually()
 {
+	// the timer lives in our thread
+	if (QThread::currentThread() != thread())
+	{
+		QMetaObject::invokeMethod(this, "SaveEventually", Qt::QueuedConnection);
+		return;
+	}
 	// reset the save timer
 	saveBatchingTimer.stop();
 	saveBatchingTimer.start(30000);
 }
 
+int HttpMetaCache::entryCount()
+{
+	int count = 0;
+	QReadLocker locker(&m_bases_lock);
+	for (auto map : m_entries)
+	{
+		for (auto &shard : map->shards)
+		{
+			QReadLocker shardLocker(&shard.lock);
+			count += shard.entries.size();
+		}
+	}
+	return count;
+}
+
 void HttpMetaCache::SaveNow()
+{
+	QMutexLocker locker(&m_journal_lock);
+	collectJournal();
+	// rewrite the whole thing when most of the journal is outdated
+	if (m_needs_compaction || !QFile::exists(m_index_file) ||
+		m_journal_records > 2 * entryCount() + 1000)
+	{
+		compact();
+		return;
+	}
+	if (m_pending_records.isEmpty())
+		return;
+
+	QFile journal(m_index_file);
+	if (!journal.open(QIODevice::WriteOnly | QIODevice::Append))
+		return;
+	qint64 result = journal.write(m_pending_records);
+	if (result != m_pending_records.size())
+	{
+		// we don't know what made it to the disk. Start over next time.
+		QLOG_ERROR() << "Failed to append to the metacache journal.";
+		m_needs_compaction = true;
+		return;
+	}
+	m_pending_records.clear();
+}
+
+// called with the journal lock held
+void HttpMetaCache::compact()
 {
 	QSaveFile tfile(m_index_file);
 	if (!tfile.open(QIODevice::WriteOnly | QIODevice::Truncate))
 		return;
-	QJsonObject toplevel;
-	toplevel.insert("version", QJsonValue(QString("1")));
-	QJsonArray entriesArr;
-	for (auto group : m_entries)
+	QByteArray data = journalHeader;
+	int records = 0;
 	{
-		for (auto entry : group.entry_list)
+		QReadLocker locker(&m_bases_lock);
+		for (auto map : m_entries)
 		{
-			QJsonObject entryObj;
-			entryObj.insert("base", QJsonValue(entry->base));
-			entryObj.insert("path", QJsonValue(entry->path));
-			entryObj.insert("md5sum", QJsonValue(entry->md5sum));
-			entryObj.insert("etag", QJsonValue(entry->etag));
-			entryObj.insert("last_changed_timestamp",
-							QJsonValue(double(entry->local_changed_timestamp)));
-			if (!entry->remote_changed_timestamp.isEmpty())
-				entryObj.insert("remote_changed_timestamp",
-								QJsonValue(entry->remote_changed_timestamp));
-			entriesArr.append(entryObj);
+			for (auto &shard : map->shards)
+			{
+				// the records of changes until now are covered by the entries
+				QWriteLocker shardLocker(&shard.lock);
+				shard.pending.clear();
+				shard.pending_records = 0;
+				for (auto entry : shard.entries)
+				{
+					data.append(updateRecord(entry));
+					records++;
+				}
+			}
 		}
 	}
-	toplevel.insert("entries", entriesArr);
-	QJsonDocument doc(toplevel);
-	QByteArray jsonData = doc.toJson();
-	qint64 result = tfile.write(jsonData);
+	// the pending records are gone, only a complete rewrite has everything now
+	m_needs_compaction = true;
+	qint64 result = tfile.write(data);
 	if (result == -1)
 		return;
-	if (result != jsonData.size())
+	if (result != data.size())
+		return;
+	if (!tfile.commit())
 		return;
-	tfile.commit();
+	m_pending_records.clear();
+	m_journal_records = records;
+	m_needs_compaction = false;
 }
@@ -16,7 +16,11 @@
 #pragma once
 #include <QString>
 #include <QMap>
+#include <QHash>
+#include <QMutex>
+#include <QReadWriteLock>
 #include <qtimer.h>
+#include <memory>
 
 struct MetaEntry
 {
@@ -32,6 +36,14 @@ struct MetaEntry
 
 typedef std::shared_ptr<MetaEntry> MetaEntryPtr;
 
+/**
+ * Keeps track of downloaded files and their HTTP metadata.
+ *
+ * Entry lookups and updates are thread safe, so download and verification workers can use
+ * the cache directly. Bases have to be added and the index loaded before that.
+ * The entries handed out are copies, changing them only changes the cache through
+ * updateEntry().
+ */
 class HttpMetaCache : public QObject
 {
 	Q_OBJECT
@@ -48,28 +60,81 @@ public:
 	MetaEntryPtr resolveEntry(QString base, QString resource_path,
 							  QString expected_etag = QString());
 
-	// add a previously resolved stale entry
+	// add a previously resolved stale entry. The cache keeps a copy of it.
 	bool updateEntry(MetaEntryPtr stale_entry);
 
 	void addBase(QString base, QString base_root);
 
-	// (re)start a timer that calls SaveNow later.
-	void SaveEventually();
 	void Load();
 	QString getBasePath(QString base);
 public
 slots:
+	// (re)start a timer that calls SaveNow later. Can be called from any thread.
+	void SaveEventually();
+	// append the changes to the journal, or rewrite it if it got too big
 	void SaveNow();
 
 private:
-	// create a new stale entry, given the parameters
-	MetaEntryPtr staleEntry(QString base, QString resource_path);
+	enum
+	{
+		ShardCount = 8
+	};
+	struct EntryShard
+	{
+		QReadWriteLock lock;
+		QHash<QString, MetaEntryPtr> entries;
+		/// journal records of changes to the entries, in the order they were made.
+		/// Written with the lock held for writing, like the change itself.
+		QByteArray pending;
+		int pending_records = 0;
+	};
 	struct EntryMap
 	{
 		QString base_path;
-		QMap<QString, MetaEntryPtr> entry_list;
+		EntryShard shards[ShardCount];
+		EntryShard &shardFor(const QString &resource_path)
+		{
+			return shards[qHash(resource_path) % ShardCount];
+		}
 	};
-	QMap<QString, EntryMap> m_entries;
+	typedef std::shared_ptr<EntryMap> EntryMapPtr;
+
+private:
+	EntryMapPtr findBase(const QString &base);
+	// a copy of the entry, and the cached one it was made from
+	MetaEntryPtr lookupEntry(const QString &base, const QString &resource_path,
+							 MetaEntryPtr &cached);
+	// create a new stale entry, given the parameters
+	MetaEntryPtr staleEntry(QString base, QString resource_path);
+	// drop the cached entry, if it is still the one in the cache, and record that in the journal
+	void removeEntry(MetaEntryPtr cached);
+
+	// record a change. Call with the shard locked for writing, right where the change is made.
+	static void journalUpdate(EntryShard &shard, MetaEntryPtr entry);
+	static void journalRemove(EntryShard &shard, QString base, QString resource_path);
+	// move the records of all shards to m_pending_records. Call with the journal lock held.
+	void collectJournal();
+	bool applyJournalRecord(const QByteArray &line);
+	void loadJson(const QByteArray &data);
+	// rewrite the journal with just the current entries
+	void compact();
+	int entryCount();
+
+private:
+	/// base name -> entries. Only changed by addBase()
+	QMap<QString, EntryMapPtr> m_entries;
+	QReadWriteLock m_bases_lock;
 	QString m_index_file;
 	QTimer saveBatchingTimer;
-};
\ No newline at end of file
+
+	/// protects the journal state below. Never lock a shard and then this.
+	/// Records are collected from the shards on save, so the order of changes to one path
+	/// is the order they were made in.
+	QMutex m_journal_lock;
+	/// journal records that were not written to the index file yet
+	QByteArray m_pending_records;
+	/// number of records in the index file, including the overwritten ones
+	int m_journal_records = 0;
+	/// the index file has to be rewritten completely on the next save
+	bool m_needs_compaction = false;
+};
@@ -19,7 +19,8 @@
 #include <QCryptographicHash>
 #include "logger/QsLog.h"
 
-MD5EtagDownload::MD5EtagDownload(QUrl url, QString target_path) : NetAction()
+MD5EtagDownload::MD5EtagDownload(QUrl url, QString target_path)
+	: NetAction(), m_output_file(target_path)
 {
 	m_url = url;
 	m_target_path = target_path;
@@ -29,16 +30,15 @@ MD5EtagDownload::MD5EtagDownload(QUrl url, QString target_path) : NetAction()
 void MD5EtagDownload::start()
 {
 	QString filename = m_target_path;
-	m_output_file.setFileName(filename);
+	QFile local_file(filename);
 	// if there already is a file and md5 checking is in effect and it can be opened
-	if (m_output_file.exists() && m_output_file.open(QIODevice::ReadOnly))
+	if (local_file.exists() && local_file.open(QIODevice::ReadOnly))
 	{
 		// get the md5 of the local file.
-		m_local_md5 =
-			QCryptographicHash::hash(m_output_file.readAll(), QCryptographicHash::Md5)
-				.toHex()
-				.constData();
-		m_output_file.close();
+		QCryptographicHash local_md5(QCryptographicHash::Md5);
+		local_md5.addData(&local_file);
+		m_local_md5 = local_md5.result().toHex().constData();
+		local_file.close();
 		// if we are expecting some md5sum, compare it with the local one
 		if (!m_expected_md5.isEmpty())
 		{
@@ -71,19 +71,15 @@ void MD5EtagDownload::start()
 		request.setRawHeader(QString("If-None-Match").toLatin1(), m_local_md5.toLatin1());
 	}
 	if(!m_expected_md5.isEmpty())
+	{
 		QLOG_INFO() << "Expecting " << m_expected_md5;
+		m_hasher.expect(QCryptographicHash::Md5, {m_expected_md5});
+	}
+	// continues where a failed attempt stopped, if it can
+	m_output_file.prepare(request, m_hasher);
 
 	request.setHeader(QNetworkRequest::UserAgentHeader, "MultiMC/5.0 (Uncached)");
 
-	// Go ahead and try to open the file.
-	// If we don't do this, empty files won't be created, which breaks the updater.
-	// Plus, this way, we don't end up starting a download for a file we can't open.
-	if (!m_output_file.open(QIODevice::WriteOnly))
-	{
-		emit failed(m_index_within_job);
-		return;
-	}
-
 	auto worker = MMC->qnam();
 	QNetworkReply *rep = worker->get(request);
 
@@ -98,9 +94,11 @@ void MD5EtagDownload::start()
 
 void MD5EtagDownload::downloadProgress(qint64 bytesReceived, qint64 bytesTotal)
 {
-	m_total_progress = bytesTotal;
-	m_progress = bytesReceived;
-	emit progress(m_index_within_job, bytesReceived, bytesTotal);
+	// count what was already on disk before this request
+	qint64 offset = m_output_file.offset();
+	m_total_progress = bytesTotal < 0 ? bytesTotal : offset + bytesTotal;
+	m_progress = offset + bytesReceived;
+	emit progress(m_index_within_job, m_progress, m_total_progress);
 }
 
 void MD5EtagDownload::downloadError(QNetworkReply::NetworkError error)
@@ -112,15 +110,61 @@ void MD5EtagDownload::downloadError(QNetworkReply::NetworkError error)
 
 void MD5EtagDownload::downloadFinished()
 {
+	// the data kept from the last attempt already was all of it
+	if (m_status == Job_Failed && !m_output_file.isWriting() &&
+		m_output_file.resumesComplete(m_reply.get()))
+	{
+		m_status = Job_InProgress;
+	}
+
 	// if the download succeeded
 	if (m_status != Job_Failed)
 	{
+		// the local file is what the server has
+		QVariant status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+		if (status.isValid() && status.toInt() == 304)
+		{
+			m_output_file.discard();
+			if (!m_expected_md5.isEmpty() && m_local_md5 != m_expected_md5)
+			{
+				QLOG_ERROR() << "Rejecting" << m_url.toString() << ": not modified, but the"
+							 << "local file doesn't match the expected md5";
+				m_status = Job_Failed;
+				m_reply.reset();
+				emit failed(m_index_within_job);
+				return;
+			}
+			m_status = Job_Finished;
+			m_reply.reset();
+			emit succeeded(m_index_within_job);
+			return;
+		}
+
+		// compare what we got with what we expected
+		QString hashError;
+		if (!m_hasher.verify(hashError))
+		{
+			QLOG_ERROR() << "Rejecting" << m_url.toString() << ":" << hashError;
+			m_status = Job_Failed;
+			m_output_file.discard();
+			m_reply.reset();
+			emit failed(m_index_within_job);
+			return;
+		}
+
+		// empty files get created too, the updater needs them
+		if (!m_output_file.commit())
+		{
+			QLOG_ERROR() << "Failed to commit changes to " << m_target_path;
+			m_status = Job_Failed;
+			m_output_file.discard();
+			m_reply.reset();
+			emit failed(m_index_within_job);
+			return;
+		}
+
 		// nothing went wrong...
 		m_status = Job_Finished;
-		m_output_file.close();
-
-		// FIXME: compare with the real written data md5sum
-		// this is just an ETag
 		QLOG_INFO() << "Finished " << m_url.toString() << " got " << m_reply->rawHeader("ETag").constData();
 
 		m_reply.reset();
@@ -130,8 +174,7 @@ void MD5EtagDownload::downloadFinished()
 	// else the download failed
 	else
 	{
-		m_output_file.close();
-		m_output_file.remove();
+		m_output_file.keep(m_reply.get());
 		m_reply.reset();
 		emit failed(m_index_within_job);
 		return;
@@ -140,17 +183,27 @@ void MD5EtagDownload::downloadFinished()
 
 void MD5EtagDownload::downloadReadyRead()
 {
-	if (!m_output_file.isOpen())
+	QByteArray ba = m_reply->readAll();
+	if (!m_output_file.isWriting())
 	{
-		if (!m_output_file.open(QIODevice::WriteOnly))
+		// redirect and error bodies don't go into the file
+		if (m_status == Job_Failed || !PartialDownload::carriesFile(m_reply.get()))
+			return;
+		if (!m_output_file.begin(m_reply.get(), m_hasher))
 		{
 			/*
-			* Can't open the file... the job failed
+			* Can't open the file, or it doesn't fit the range we got... the job failed
 			*/
-			m_reply->abort();
-			emit failed(m_index_within_job);
+			m_output_file.discard();
+			m_status = Job_Failed;
+			QMetaObject::invokeMethod(m_reply.get(), "abort", Qt::QueuedConnection);
 			return;
 		}
 	}
-	m_output_file.write(m_reply->readAll());
+	m_hasher.addData(ba);
+	if (!m_output_file.write(ba))
+	{
+		m_status = Job_Failed;
+		QMetaObject::invokeMethod(m_reply.get(), "abort", Qt::QueuedConnection);
+	}
 }
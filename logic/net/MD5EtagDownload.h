@@ -16,7 +16,7 @@
 #pragma once
 
 #include "NetAction.h"
-#include <QFile>
+#include "PartialDownload.h"
 
 typedef std::shared_ptr<class MD5EtagDownload> Md5EtagDownloadPtr;
 class MD5EtagDownload : public NetAction
@@ -29,8 +29,8 @@ public:
 	QString m_local_md5;
 	/// if saving to file, use the one specified in this string
 	QString m_target_path;
-	/// this is the output file, if any
-	QFile m_output_file;
+	/// the data goes here first, and stays there to be resumed if the download fails
+	PartialDownload m_output_file;
 
 public:
 	explicit MD5EtagDownload(QUrl url, QString target_path);
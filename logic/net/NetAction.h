@@ -19,6 +19,7 @@
 #include <QUrl>
 #include <memory>
 #include <QNetworkReply>
+#include "StreamHasher.h"
 
 enum JobStatus
 {
@@ -73,6 +74,9 @@ public:
 	/// number of failures up to this point
 	int m_failures = 0;
 
+	/// hashes the data as it arrives. Set expectations on it before starting the action.
+	StreamHasher m_hasher;
+
 signals:
 	void started(int index);
 	void progress(int index, qint64 current, qint64 total);
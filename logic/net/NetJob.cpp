@@ -66,7 +66,8 @@ void NetJob::partFailed(int index)
 					 << ")";
 		// restart the job
 		slot.failures++;
-		downloads[index]->start();
+		scheduler()->enqueue(downloads[index], m_priority);
+		scheduler()->schedule();
 	}
 }
 
@@ -90,12 +91,24 @@ void NetJob::start()
 	m_running = true;
 	for (auto iter : downloads)
 	{
-		connect(iter.get(), SIGNAL(succeeded(int)), SLOT(partSucceeded(int)));
-		connect(iter.get(), SIGNAL(failed(int)), SLOT(partFailed(int)));
-		connect(iter.get(), SIGNAL(progress(int, qint64, qint64)),
-				SLOT(partProgress(int, qint64, qint64)));
-		iter->start();
+		enqueuePart(iter);
 	}
+	scheduler()->schedule();
+}
+
+NetScheduler *NetJob::scheduler()
+{
+	return MMC->netScheduler().get();
+}
+
+void NetJob::enqueuePart(NetActionPtr action)
+{
+	// the scheduler connects to the action first, so it can free the slot before we react
+	scheduler()->enqueue(action, m_priority);
+	connect(action.get(), SIGNAL(succeeded(int)), SLOT(partSucceeded(int)));
+	connect(action.get(), SIGNAL(failed(int)), SLOT(partFailed(int)));
+	connect(action.get(), SIGNAL(progress(int, qint64, qint64)),
+			SLOT(partProgress(int, qint64, qint64)));
 }
 
 QStringList NetJob::getFailedFiles()
@@ -21,6 +21,7 @@
 #include "MD5EtagDownload.h"
 #include "CacheDownload.h"
 #include "HttpMetaCache.h"
+#include "NetScheduler.h"
 #include "logic/tasks/ProgressProvider.h"
 
 class NetJob;
@@ -45,19 +46,26 @@ public:
 		}
 		parts_progress.append(pi);
 		total_progress += pi.total_progress;
-		// if this is already running, the action needs to be started right away!
+		// if this is already running, the action needs to be scheduled right away!
 		if (isRunning())
 		{
 			emit progress(current_progress, total_progress);
-			connect(base.get(), SIGNAL(succeeded(int)), SLOT(partSucceeded(int)));
-			connect(base.get(), SIGNAL(failed(int)), SLOT(partFailed(int)));
-			connect(base.get(), SIGNAL(progress(int, qint64, qint64)),
-					SLOT(partProgress(int, qint64, qint64)));
-			base->start();
+			enqueuePart(base);
+			scheduler()->schedule();
 		}
 		return true;
 	}
 
+	/// The priority this job's actions are scheduled with. Set it before starting the job.
+	void setPriority(NetJobPriority priority)
+	{
+		m_priority = priority;
+	}
+	NetJobPriority priority() const
+	{
+		return m_priority;
+	}
+
 	NetActionPtr operator[](int index)
 	{
 		return downloads[index];
@@ -97,6 +105,10 @@ slots:
 	void partSucceeded(int index);
 	void partFailed(int index);
 
+private:
+	NetScheduler *scheduler();
+	void enqueuePart(NetActionPtr action);
+
 private:
 	struct part_info
 	{
@@ -112,4 +124,5 @@ private:
 	int num_succeeded = 0;
 	int num_failed = 0;
 	bool m_running = false;
+	NetJobPriority m_priority = Priority_Normal;
 };
@@ -0,0 +1,107 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NetScheduler.h"
+
+NetScheduler::NetScheduler(int maxRunning, int maxRunningPerHost, QObject *parent)
+	: QObject(parent), m_max_running(maxRunning), m_max_running_per_host(maxRunningPerHost)
+{
+}
+
+void NetScheduler::enqueue(NetActionPtr action, NetJobPriority priority)
+{
+	// this has to be the first connection, so the slot is free before anyone restarts the action
+	connect(action.get(), SIGNAL(succeeded(int)), SLOT(actionDone()), Qt::UniqueConnection);
+	connect(action.get(), SIGNAL(failed(int)), SLOT(actionDone()), Qt::UniqueConnection);
+	connect(action.get(), SIGNAL(destroyed(QObject *)), SLOT(actionDestroyed(QObject *)),
+			Qt::UniqueConnection);
+	m_queues[priority][action->m_url.host()].enqueue(action);
+	m_queued++;
+}
+
+void NetScheduler::schedule()
+{
+	// starting an action can finish it right away, which calls back into this
+	if (m_scheduling)
+		return;
+	m_scheduling = true;
+	auto prio_iter = m_queues.begin();
+	while (prio_iter != m_queues.end() && m_running.size() < m_max_running)
+	{
+		auto &hosts = prio_iter.value();
+		bool started = false;
+		for (auto host_iter = hosts.begin(); host_iter != hosts.end();)
+		{
+			if (m_running.size() >= m_max_running)
+				break;
+			auto &queue = host_iter.value();
+			const QString &host = host_iter.key();
+			if (queue.isEmpty())
+			{
+				host_iter = hosts.erase(host_iter);
+				continue;
+			}
+			if (m_running_per_host.value(host) >= m_max_running_per_host)
+			{
+				host_iter++;
+				continue;
+			}
+			auto action = queue.dequeue().lock();
+			m_queued--;
+			// the owner of the action is gone
+			if (!action)
+				continue;
+			m_running[action.get()] = host;
+			m_running_per_host[host]++;
+			started = true;
+			action->start();
+			// the action could have been done already, restart from the top priority
+			break;
+		}
+		if (started)
+		{
+			prio_iter = m_queues.begin();
+			continue;
+		}
+		if (hosts.isEmpty())
+			prio_iter = m_queues.erase(prio_iter);
+		else
+			prio_iter++;
+	}
+	m_scheduling = false;
+}
+
+void NetScheduler::release(QObject *action)
+{
+	auto iter = m_running.find(action);
+	if (iter == m_running.end())
+		return;
+	QString host = iter.value();
+	m_running.erase(iter);
+	if (--m_running_per_host[host] <= 0)
+		m_running_per_host.remove(host);
+}
+
+void NetScheduler::actionDone()
+{
+	release(sender());
+	schedule();
+}
+
+void NetScheduler::actionDestroyed(QObject *action)
+{
+	release(action);
+	schedule();
+}
@@ -0,0 +1,89 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QQueue>
+#include <memory>
+#include "NetAction.h"
+
+enum NetJobPriority
+{
+	/// things the user is actively waiting for, like version lists
+	Priority_Interactive,
+	/// regular downloads
+	Priority_Normal,
+	/// big batches of files, like assets
+	Priority_Bulk
+};
+
+/**
+ * Decides when queued NetActions get started.
+ *
+ * Keeps the number of running actions under a global limit and a per-host limit.
+ * Queued actions of a higher priority always go first.
+ */
+class NetScheduler : public QObject
+{
+	Q_OBJECT
+public:
+	explicit NetScheduler(int maxRunning = 16, int maxRunningPerHost = 6,
+						  QObject *parent = 0);
+	virtual ~NetScheduler(){};
+
+	/**
+	 * Queue an action. It isn't started until schedule() gets called.
+	 * The scheduler notices the action finishing or failing on its own.
+	 */
+	void enqueue(NetActionPtr action, NetJobPriority priority);
+
+	int runningCount() const
+	{
+		return m_running.size();
+	}
+	int queuedCount() const
+	{
+		return m_queued;
+	}
+
+public
+slots:
+	/// start as many queued actions as the limits allow
+	void schedule();
+
+private
+slots:
+	void actionDone();
+	void actionDestroyed(QObject *action);
+
+private:
+	void release(QObject *action);
+
+private:
+	typedef QQueue<std::weak_ptr<NetAction>> ActionQueue;
+	/// priority -> host -> queued actions
+	QMap<int, QMap<QString, ActionQueue>> m_queues;
+	/// running action -> its host
+	QHash<QObject *, QString> m_running;
+	/// host -> number of running actions
+	QHash<QString, int> m_running_per_host;
+	int m_queued = 0;
+	int m_max_running;
+	int m_max_running_per_host;
+	bool m_scheduling = false;
+};
@@ -0,0 +1,146 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PartialDownload.h"
+#include "logger/QsLog.h"
+#include <pathutils.h>
+
+PartialDownload::PartialDownload(QString target_path)
+	: m_target_path(target_path), m_file(target_path + ".part")
+{
+}
+
+void PartialDownload::prepare(QNetworkRequest &request, StreamHasher &hasher)
+{
+	m_file.close();
+	m_offset = 0;
+	hasher.reset();
+	// anything without a validator is from an earlier session, or can't be resumed
+	if (m_validator.isEmpty() || m_file.size() == 0 || !m_file.open(QIODevice::ReadOnly))
+	{
+		discard();
+		return;
+	}
+	// the hash has to cover the whole file, not just the rest of it
+	QByteArray chunk;
+	while (!(chunk = m_file.read(64 * 1024)).isEmpty())
+	{
+		hasher.addData(chunk);
+		m_offset += chunk.size();
+	}
+	m_file.close();
+	QLOG_INFO() << "Resuming" << request.url().toString() << "from" << m_offset << "bytes";
+	request.setRawHeader("Range", "bytes=" + QByteArray::number(m_offset) + "-");
+	request.setRawHeader("If-Range", m_validator);
+}
+
+bool PartialDownload::carriesFile(QNetworkReply *reply)
+{
+	QVariant status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+	// not HTTP, the body is the file
+	if (!status.isValid())
+		return true;
+	return status.toInt() == 200 || status.toInt() == 206;
+}
+
+bool PartialDownload::begin(QNetworkReply *reply, StreamHasher &hasher)
+{
+	QVariant status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+	if (status.isValid() && status.toInt() == 206)
+	{
+		// "bytes <first>-<last>/<length>", the rest has to start right where we are
+		QByteArray range = reply->rawHeader("Content-Range");
+		bool ok = false;
+		qint64 first = 0;
+		if (range.startsWith("bytes "))
+			first = range.mid(6, range.indexOf('-') - 6).trimmed().toLongLong(&ok);
+		if (!ok || m_offset == 0 || first != m_offset)
+		{
+			QLOG_ERROR() << "Unusable Content-Range" << range << "for" << m_file.fileName();
+			return false;
+		}
+		return m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+	}
+	// the server sends everything, because it changed or doesn't do ranges
+	m_offset = 0;
+	hasher.reset();
+	return m_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+}
+
+bool PartialDownload::resumesComplete(QNetworkReply *reply)
+{
+	QVariant status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+	if (m_offset == 0 || !status.isValid() || status.toInt() != 416)
+		return false;
+	// "bytes */<length>". If the server says how long the file is, it has to be what we have.
+	QByteArray range = reply->rawHeader("Content-Range");
+	if (range.startsWith("bytes */"))
+	{
+		bool ok = false;
+		qint64 length = range.mid(8).trimmed().toLongLong(&ok);
+		if (!ok || length != m_offset)
+			return false;
+	}
+	QLOG_INFO() << "Kept data of" << m_file.fileName() << "is already complete";
+	return m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+bool PartialDownload::write(const QByteArray &data)
+{
+	return m_file.write(data) == data.size();
+}
+
+void PartialDownload::keep(QNetworkReply *reply)
+{
+	// if nothing was written, the kept data and its validator are still what they were
+	if (!m_file.isOpen())
+		return;
+	m_file.close();
+	m_validator.clear();
+	QByteArray etag = reply->rawHeader("ETag");
+	// If-Range only works with strong validators
+	if (!etag.isEmpty() && !etag.startsWith("W/"))
+		m_validator = etag;
+	else if (reply->hasRawHeader("Last-Modified"))
+		m_validator = reply->rawHeader("Last-Modified");
+
+	if (m_validator.isEmpty() || m_file.size() == 0)
+		discard();
+}
+
+void PartialDownload::discard()
+{
+	m_file.close();
+	m_file.remove();
+	m_validator.clear();
+	m_offset = 0;
+}
+
+bool PartialDownload::commit()
+{
+	// nothing arrived, so the file is empty
+	if (!m_file.isOpen() && !m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	m_file.close();
+	m_validator.clear();
+	m_offset = 0;
+	// the old file stays until the new one takes its place
+	if (!replaceFile(m_file.fileName(), m_target_path))
+	{
+		QLOG_ERROR() << "Couldn't replace" << m_target_path;
+		return false;
+	}
+	return true;
+}
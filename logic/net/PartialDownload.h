@@ -0,0 +1,87 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QFile>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include "StreamHasher.h"
+
+/**
+ * The sidecar file ("<target>.part") a download is written to.
+ *
+ * When a download fails, what arrived so far is kept, along with the reply's validator
+ * (a strong ETag or Last-Modified). The next attempt then asks only for the rest, with
+ * Range and If-Range. If the file changed on the server in between, it sends all of it.
+ */
+class PartialDownload
+{
+public:
+	explicit PartialDownload(QString target_path);
+
+	/**
+	 * Set up the request for a new attempt. If there is something to resume, the hasher
+	 * is fed the data already on disk and the request asks for the rest only.
+	 */
+	void prepare(QNetworkRequest &request, StreamHasher &hasher);
+
+	/// true if the body of the reply is (a part of) the file, not a redirect or an error page
+	static bool carriesFile(QNetworkReply *reply);
+
+	/**
+	 * Call before writing the first data of a reply that carries the file. Decides between
+	 * appending and starting over, resetting the hasher for the latter.
+	 * false if the reply doesn't fit the data on disk, or the file can't be opened.
+	 */
+	bool begin(QNetworkReply *reply, StreamHasher &hasher);
+
+	/**
+	 * Call when the reply failed. true if it was a 416 because the kept data already is
+	 * the whole file. That data then is ready to be verified and committed, like after
+	 * begin() and write().
+	 */
+	bool resumesComplete(QNetworkReply *reply);
+
+	/// true between begin() or resumesComplete() and commit(), keep() or discard()
+	bool isWriting() const
+	{
+		return m_file.isOpen();
+	}
+
+	/// bytes that were already on disk when the current reply started
+	qint64 offset() const
+	{
+		return m_offset;
+	}
+
+	bool write(const QByteArray &data);
+
+	/// the download failed. Keep the data if the reply allows resuming it later.
+	void keep(QNetworkReply *reply);
+
+	/// throw away the data
+	void discard();
+
+	/// replace the target with the downloaded data. Creates an empty target if nothing was written.
+	bool commit();
+
+private:
+	QString m_target_path;
+	QFile m_file;
+	/// what the kept data is checked against on the server (If-Range)
+	QByteArray m_validator;
+	qint64 m_offset = 0;
+};
@@ -0,0 +1,160 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StreamHasher.h"
+
+static QString algorithmName(QCryptographicHash::Algorithm algorithm)
+{
+	switch (algorithm)
+	{
+	case QCryptographicHash::Md5:
+		return "MD5";
+	case QCryptographicHash::Sha1:
+		return "SHA-1";
+	case QCryptographicHash::Sha256:
+		return "SHA-256";
+	default:
+		return "hash";
+	}
+}
+
+StreamHasher::StreamHasher(const StreamHasher &other)
+{
+	*this = other;
+}
+
+StreamHasher &StreamHasher::operator=(const StreamHasher &other)
+{
+	m_stages.clear();
+	for (auto &otherStage : other.m_stages)
+	{
+		Stage copy;
+		copy.algorithm = otherStage.algorithm;
+		copy.hash = std::make_shared<QCryptographicHash>(otherStage.algorithm);
+		copy.expected = otherStage.expected;
+		m_stages.append(copy);
+	}
+	return *this;
+}
+
+StreamHasher::Stage &StreamHasher::stage(QCryptographicHash::Algorithm algorithm)
+{
+	for (auto &existing : m_stages)
+	{
+		if (existing.algorithm == algorithm)
+			return existing;
+	}
+	Stage added;
+	added.algorithm = algorithm;
+	added.hash = std::make_shared<QCryptographicHash>(algorithm);
+	m_stages.append(added);
+	return m_stages.last();
+}
+
+void StreamHasher::enable(QCryptographicHash::Algorithm algorithm)
+{
+	stage(algorithm);
+}
+
+void StreamHasher::expect(QCryptographicHash::Algorithm algorithm, QStringList hexHashes)
+{
+	// don't hash for nothing
+	if (hexHashes.isEmpty())
+		return;
+	auto &expecting = stage(algorithm);
+	for (auto hexHash : hexHashes)
+	{
+		hexHash = hexHash.toLower();
+		if (!hexHash.isEmpty() && !expecting.expected.contains(hexHash))
+			expecting.expected.append(hexHash);
+	}
+}
+
+bool StreamHasher::expectHex(QString hexHash)
+{
+	switch (hexHash.size())
+	{
+	case 32:
+		expect(QCryptographicHash::Md5, {hexHash});
+		return true;
+	case 40:
+		expect(QCryptographicHash::Sha1, {hexHash});
+		return true;
+	case 64:
+		expect(QCryptographicHash::Sha256, {hexHash});
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool StreamHasher::hasExpectations() const
+{
+	for (auto &existing : m_stages)
+	{
+		if (!existing.expected.isEmpty())
+			return true;
+	}
+	return false;
+}
+
+void StreamHasher::reset()
+{
+	for (auto &existing : m_stages)
+	{
+		existing.hash->reset();
+	}
+}
+
+void StreamHasher::addData(const char *data, int length)
+{
+	for (auto &existing : m_stages)
+	{
+		existing.hash->addData(data, length);
+	}
+}
+
+void StreamHasher::addData(const QByteArray &data)
+{
+	addData(data.constData(), data.size());
+}
+
+QString StreamHasher::result(QCryptographicHash::Algorithm algorithm)
+{
+	for (auto &existing : m_stages)
+	{
+		if (existing.algorithm == algorithm)
+			return existing.hash->result().toHex().constData();
+	}
+	return QString();
+}
+
+bool StreamHasher::verify(QString &error)
+{
+	for (auto &existing : m_stages)
+	{
+		if (existing.expected.isEmpty())
+			continue;
+		QString actual = existing.hash->result().toHex().constData();
+		if (!existing.expected.contains(actual))
+		{
+			error = QString("%1 mismatch: got %2, expected %3")
+						.arg(algorithmName(existing.algorithm), actual,
+							 existing.expected.join(" or "));
+			return false;
+		}
+	}
+	return true;
+}
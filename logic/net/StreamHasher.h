@@ -0,0 +1,71 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QCryptographicHash>
+#include <QStringList>
+#include <QList>
+#include <memory>
+
+/**
+ * Hashes data as it streams through, with any mix of MD5, SHA-1 and SHA-256 at once,
+ * and checks the results against expected checksums.
+ *
+ * Copies keep what is enabled and expected, but not the data hashed so far.
+ */
+class StreamHasher
+{
+public:
+	StreamHasher(){};
+	StreamHasher(const StreamHasher &other);
+	StreamHasher &operator=(const StreamHasher &other);
+
+	/// compute this kind of hash, without expecting anything in particular
+	void enable(QCryptographicHash::Algorithm algorithm);
+
+	/// the data has to match one of the given hex encoded hashes
+	void expect(QCryptographicHash::Algorithm algorithm, QStringList hexHashes);
+
+	/// like expect(), with the algorithm guessed from the length of the hash. false if unknown.
+	bool expectHex(QString hexHash);
+
+	/// true if anything is expected from the data
+	bool hasExpectations() const;
+
+	/// start over, keeping what is enabled and expected
+	void reset();
+
+	void addData(const char *data, int length);
+	void addData(const QByteArray &data);
+
+	/// hex encoded hash of the data so far. Empty if the algorithm isn't enabled.
+	QString result(QCryptographicHash::Algorithm algorithm);
+
+	/// check the data against the expected hashes. On mismatch, the reason ends up in error.
+	bool verify(QString &error);
+
+private:
+	struct Stage
+	{
+		QCryptographicHash::Algorithm algorithm;
+		std::shared_ptr<QCryptographicHash> hash;
+		QStringList expected;
+	};
+	Stage &stage(QCryptographicHash::Algorithm algorithm);
+
+private:
+	QList<Stage> m_stages;
+};
@@ -16,8 +16,10 @@
 #include "logic/settings/INIFile.h"
 
 #include <QFile>
+#include <QSaveFile>
 #include <QTextStream>
 #include <QStringList>
+#include <cstring>
 
 INIFile::INIFile()
 {
@@ -72,9 +74,10 @@ QString INIFile::escape(QString orig)
 
 bool INIFile::saveFile(QString fileName)
 {
-	// TODO Handle errors.
-	QFile file(fileName);
-	file.open(QIODevice::WriteOnly);
+	// replaced in one go, a crash can't leave half a file behind
+	QSaveFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
 	QTextStream out(&file);
 	out.setCodec("UTF-8");
 
@@ -84,8 +87,13 @@ bool INIFile::saveFile(QString fileName)
 		value = escape(value);
 		out << iter.key() << "=" << value << "\n";
 	}
-
-	return true;
+	out.flush();
+	if (out.status() != QTextStream::Ok)
+	{
+		file.cancelWriting();
+		return false;
+	}
+	return file.commit();
 }
 
 bool INIFile::loadFile(QString fileName)
@@ -97,28 +105,61 @@ bool INIFile::loadFile(QString fileName)
 	file.close();
 	return success;
 }
+static inline bool isAsciiSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+/// trim ASCII whitespace from both ends of [begin, end)
+static inline void trimRange(const char *&begin, const char *&end)
+{
+	while (begin < end && isAsciiSpace(*begin))
+		begin++;
+	while (end > begin && isAsciiSpace(end[-1]))
+		end--;
+}
+
+/// decode [begin, end) as UTF-8. trimmed() catches the non-ASCII whitespace.
+static inline QString decodeRange(const char *begin, const char *end)
+{
+	return QString::fromUtf8(begin, end - begin).trimmed();
+}
+
 bool INIFile::loadFile(QByteArray file)
 {
-	QTextStream in(file);
-	in.setCodec("UTF-8");
+	// one pass over the raw UTF-8, only the keys and values get allocated
+	const char *pos = file.constData();
+	const char *fileEnd = pos + file.size();
+	if (file.startsWith("\xEF\xBB\xBF"))
+		pos += 3;
 
-	QStringList lines = in.readAll().split('\n');
-	for (int i = 0; i < lines.count(); i++)
+	while (pos < fileEnd)
 	{
-		QString &lineRaw = lines[i];
-		// Ignore comments.
-		QString line = lineRaw.left(lineRaw.indexOf('#')).trimmed();
-
-		int eqPos = line.indexOf('=');
-		if (eqPos == -1)
-			continue;
-		QString key = line.left(eqPos).trimmed();
-		QString valueStr = line.right(line.length() - eqPos - 1).trimmed();
+		const char *lineEnd = (const char *)memchr(pos, '\n', fileEnd - pos);
+		if (!lineEnd)
+			lineEnd = fileEnd;
+		const char *next = lineEnd + 1;
 
-		valueStr = unescape(valueStr);
+		// Ignore comments.
+		const char *hash = (const char *)memchr(pos, '#', lineEnd - pos);
+		if (hash)
+			lineEnd = hash;
 
-		QVariant value(valueStr);
-		this->operator[](key) = value;
+		const char *eq = (const char *)memchr(pos, '=', lineEnd - pos);
+		if (eq)
+		{
+			const char *keyBegin = pos, *keyEnd = eq;
+			const char *valueBegin = eq + 1, *valueEnd = lineEnd;
+			trimRange(keyBegin, keyEnd);
+			trimRange(valueBegin, valueEnd);
+			QString key = decodeRange(keyBegin, keyEnd);
+
+			QString value = decodeRange(valueBegin, valueEnd);
+			if (memchr(valueBegin, '\\', valueEnd - valueBegin))
+				value = unescape(value);
+			this->operator[](key) = value;
+		}
+		pos = next;
 	}
 
 	return true;
@@ -15,12 +15,54 @@
 
 #include "INISettingsObject.h"
 #include "Setting.h"
+#include "logger/QsLog.h"
+
+// how long to wait for more changes before writing them
+static const int saveDelay = 500;
 
 INISettingsObject::INISettingsObject(const QString &path, QObject *parent)
-	: SettingsObject(parent)
+	: SettingsObject(parent), m_saveTimer(this)
 {
 	m_filePath = path;
 	m_ini.loadFile(path);
+	m_saveTimer.setSingleShot(true);
+	m_saveTimer.setInterval(saveDelay);
+	connect(&m_saveTimer, SIGNAL(timeout()), SLOT(flush()));
+}
+
+INISettingsObject::INISettingsObject(const QString &path, const INIFile &contents,
+									 QObject *parent)
+	: SettingsObject(parent), m_ini(contents), m_saveTimer(this)
+{
+	m_filePath = path;
+	m_saveTimer.setSingleShot(true);
+	m_saveTimer.setInterval(saveDelay);
+	connect(&m_saveTimer, SIGNAL(timeout()), SLOT(flush()));
+}
+
+INISettingsObject::~INISettingsObject()
+{
+	flush();
+}
+
+void INISettingsObject::scheduleSave()
+{
+	m_dirty = true;
+	m_saveTimer.start();
+}
+
+bool INISettingsObject::flush()
+{
+	m_saveTimer.stop();
+	if (!m_dirty)
+		return true;
+	if (!m_ini.saveFile(m_filePath))
+	{
+		QLOG_ERROR() << "Failed to save settings to" << m_filePath;
+		return false;
+	}
+	m_dirty = false;
+	return true;
 }
 
 void INISettingsObject::setFilePath(const QString &filePath)
@@ -30,13 +72,24 @@ void INISettingsObject::setFilePath(const QString &filePath)
 
 bool INISettingsObject::reload()
 {
+	m_mayBeOutdated = false;
 	return m_ini.loadFile(m_filePath) && SettingsObject::reload();
 }
 
+void INISettingsObject::ensureCurrent()
+{
+	if (!m_mayBeOutdated)
+		return;
+	m_mayBeOutdated = false;
+	// changes on top of outdated contents would overwrite the newer file
+	m_ini.loadFile(m_filePath);
+}
+
 void INISettingsObject::changeSetting(const Setting &setting, QVariant value)
 {
 	if (contains(setting.id()))
 	{
+		ensureCurrent();
 		// valid value -> set the main config, remove all the sysnonyms
 		if (value.isValid())
 		{
@@ -51,7 +104,7 @@ void INISettingsObject::changeSetting(const Setting &setting, QVariant value)
 			for(auto iter: setting.configKeys())
 				m_ini.remove(iter);
 		}
-		m_ini.saveFile(m_filePath);
+		scheduleSave();
 	}
 }
 
@@ -60,9 +113,10 @@ void INISettingsObject::resetSetting(const Setting &setting)
 	// if we have the setting, remove all the synonyms. ALL OF THEM
 	if (contains(setting.id()))
 	{
+		ensureCurrent();
 		for(auto iter: setting.configKeys())
 			m_ini.remove(iter);
-		m_ini.saveFile(m_filePath);
+		scheduleSave();
 	}
 }
 
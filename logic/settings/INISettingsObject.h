@@ -16,6 +16,7 @@
 #pragma once
 
 #include <QObject>
+#include <QTimer>
 
 #include "logic/settings/INIFile.h"
 
@@ -23,6 +24,9 @@
 
 /*!
  * \brief A settings object that stores its settings in an INIFile.
+ *
+ * Changes are written behind: a burst of them ends up in the file with one write,
+ * shortly after the last one. Call flush() when the file has to be current.
  */
 class INISettingsObject : public SettingsObject
 {
@@ -30,6 +34,10 @@ class INISettingsObject : public SettingsObject
 public:
 	explicit INISettingsObject(const QString &path, QObject *parent = 0);
 
+	/// Use contents that were already read from the file at path.
+	INISettingsObject(const QString &path, const INIFile &contents, QObject *parent = 0);
+	virtual ~INISettingsObject();
+
 	/*!
 	 * \brief Gets the path to the INI file.
 	 * \return The path to the INI file.
@@ -47,6 +55,22 @@ public:
 
 	bool reload() override;
 
+	/// The contents may be older than the file. It is read again before the first change.
+	void setMayBeOutdated()
+	{
+		m_mayBeOutdated = true;
+	}
+
+	/// What is currently stored in the INI file.
+	const INIFile &contents() const
+	{
+		return m_ini;
+	}
+
+public
+slots:
+	bool flush() override;
+
 protected
 slots:
 	virtual void changeSetting(const Setting &setting, QVariant value);
@@ -55,7 +79,17 @@ slots:
 protected:
 	virtual QVariant retrieveValue(const Setting &setting);
 
+	/// mark the file as outdated and save it after a while
+	void scheduleSave();
+
+	/// read the file again if the contents came from somewhere that may be outdated
+	void ensureCurrent();
+
 	INIFile m_ini;
 
 	QString m_filePath;
+
+	bool m_dirty = false;
+	bool m_mayBeOutdated = false;
+	QTimer m_saveTimer;
 };
@@ -112,6 +112,11 @@ bool SettingsObject::reload()
 	return true;
 }
 
+bool SettingsObject::flush()
+{
+	return true;
+}
+
 void SettingsObject::connectSignals(const Setting &setting)
 {
 	connect(&setting, SIGNAL(SettingChanged(const Setting &, QVariant)),
@@ -117,6 +117,14 @@ public:
 	 */
 	virtual bool reload();
 
+public
+slots:
+	/*!
+	 * \brief Writes changes that are still pending to the storage right away.
+	 * \return True if everything is stored
+	 */
+	virtual bool flush();
+
 signals:
 	/*!
 	 * \brief Signal emitted when one of this SettingsObject object's settings changes.
@@ -0,0 +1,111 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QCryptographicHash>
+#include <QEventLoop>
+#include <QTimer>
+
+#include "TestUtil.h"
+
+#include "logic/assets/AssetsVerifyTask.h"
+
+class AssetsVerifyTaskTest : public QObject
+{
+	Q_OBJECT
+private:
+	QTemporaryDir m_dir;
+	QString m_oldCurrent;
+	QStringList m_valid;
+	QString m_corrupt;
+
+	/// put an object into assets/objects. With damaged, its content doesn't match its name.
+	static QString addObject(int size, bool damaged = false)
+	{
+		QByteArray content;
+		for (int i = 0; i < size; i++)
+			content.append(char(qrand()));
+		QString hash =
+			QCryptographicHash::hash(content, QCryptographicHash::Sha1).toHex().constData();
+		if (damaged)
+			content[0] = content[0] ^ 0x55;
+		QDir().mkpath("assets/objects/" + hash.left(2));
+		QFile file("assets/objects/" + hash.left(2) + "/" + hash);
+		file.open(QIODevice::WriteOnly);
+		file.write(content);
+		return hash;
+	}
+
+	static bool runTask(AssetsVerifyTask &task)
+	{
+		QSignalSpy succeededSpy(&task, SIGNAL(succeeded()));
+		QEventLoop loop;
+		connect(&task, SIGNAL(succeeded()), &loop, SLOT(quit()));
+		connect(&task, SIGNAL(failed(QString)), &loop, SLOT(quit()));
+		QTimer::singleShot(60000, &loop, SLOT(quit()));
+		task.start();
+		loop.exec();
+		return succeededSpy.count() == 1;
+	}
+
+private
+slots:
+	void initTestCase()
+	{
+		QVERIFY(m_dir.isValid());
+		// the task works on the assets folder in the current directory, like MultiMC does
+		m_oldCurrent = QDir::currentPath();
+		QVERIFY(QDir::setCurrent(m_dir.path()));
+		for (int i = 0; i < 20; i++)
+			m_valid.append(addObject(100 + i * 37));
+		m_corrupt = addObject(500, true);
+		// not named like an object, the store is not only objects
+		QFile other("assets/objects/readme.txt");
+		QVERIFY(other.open(QIODevice::WriteOnly));
+		other.write("not an object");
+	}
+
+	void cleanupTestCase()
+	{
+		QDir::setCurrent(m_oldCurrent);
+	}
+
+	void test_WholeStore()
+	{
+		AssetsVerifyTask task;
+		task.setRemoveInvalid(true);
+		QVERIFY(runTask(task));
+		auto invalid = task.invalidObjects();
+		QCOMPARE(invalid.size(), 1);
+		QCOMPARE(invalid.first().hash, m_corrupt);
+		QVERIFY(!QFile::exists("assets/objects/" + m_corrupt.left(2) + "/" + m_corrupt));
+		for (auto hash : m_valid)
+			QVERIFY(QFile::exists("assets/objects/" + hash.left(2) + "/" + hash));
+		QVERIFY(QFile::exists("assets/objects/readme.txt"));
+		QVERIFY(QFile::exists("assets/objects/.verified"));
+	}
+
+	void test_WholeStoreAgain()
+	{
+		// the stamps from the first run are used, and the result stays the same
+		AssetsVerifyTask task;
+		QVERIFY(runTask(task));
+		QVERIFY(task.invalidObjects().isEmpty());
+	}
+
+	void test_GivenObjects()
+	{
+		QList<AssetObject> objects;
+		objects.append({m_valid.first(), 100});
+		objects.append({m_corrupt, 500});
+		AssetsVerifyTask task(objects);
+		QVERIFY(runTask(task));
+		// the damaged one was removed by the whole store run, so it's missing now
+		auto invalid = task.invalidObjects();
+		QCOMPARE(invalid.size(), 1);
+		QCOMPARE(invalid.first().hash, m_corrupt);
+	}
+};
+
+QTEST_GUILESS_MAIN_MULTIMC(AssetsVerifyTaskTest)
+
+#include "tst_AssetsVerifyTask.moc"
@@ -0,0 +1,231 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QCryptographicHash>
+#include <QEventLoop>
+#include <QTimer>
+
+#include "TestUtil.h"
+
+#include "logic/net/NetJob.h"
+#include "logic/net/BatchDownload.h"
+
+/// Stand-in for the resources server: HTTP/1.1 with keep-alive and pipelining, from memory
+class ObjectServer : public QTcpServer
+{
+	Q_OBJECT
+public:
+	/// path -> content
+	QHash<QString, QByteArray> files;
+	int connections = 0;
+	int requests = 0;
+
+	QUrl baseUrl() const
+	{
+		return QUrl(QString("http://127.0.0.1:%1/").arg(serverPort()));
+	}
+
+	/// add a file with random content, named like an assets object. Returns the hash.
+	QString addObject(int size)
+	{
+		QByteArray content;
+		content.reserve(size);
+		for (int i = 0; i < size; i++)
+			content.append(char(qrand()));
+		QString hash =
+			QCryptographicHash::hash(content, QCryptographicHash::Sha1).toHex().constData();
+		files.insert("/" + hash.left(2) + "/" + hash, content);
+		return hash;
+	}
+
+protected:
+	virtual void incomingConnection(qintptr handle)
+	{
+		auto socket = new QTcpSocket(this);
+		socket->setSocketDescriptor(handle);
+		connections++;
+		connect(socket, &QTcpSocket::readyRead, [this, socket]()
+		{ serve(socket); });
+		connect(socket, &QTcpSocket::disconnected, [this, socket]()
+		{
+			m_buffers.remove(socket);
+			socket->deleteLater();
+		});
+	}
+
+private:
+	void serve(QTcpSocket *socket)
+	{
+		auto &buffer = m_buffers[socket];
+		buffer.append(socket->readAll());
+		int end;
+		// answer every complete request, pipelined ones included
+		while ((end = buffer.indexOf("\r\n\r\n")) >= 0)
+		{
+			QByteArray head = buffer.left(end);
+			buffer.remove(0, end + 4);
+			QString path = QString::fromLatin1(head.left(head.indexOf("\r\n")).split(' ').value(1));
+			requests++;
+			QByteArray response;
+			QByteArray body;
+			if (files.contains(path))
+			{
+				body = files.value(path);
+				response = "HTTP/1.1 200 OK\r\n";
+			}
+			else
+			{
+				response = "HTTP/1.1 404 Not Found\r\n";
+			}
+			response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+			response += "Connection: keep-alive\r\n\r\n";
+			response += body;
+			socket->write(response);
+		}
+	}
+
+private:
+	QHash<QTcpSocket *, QByteArray> m_buffers;
+};
+
+class BatchDownloadTest : public QObject
+{
+	Q_OBJECT
+private:
+	static BatchDownloadPtr makeBatch(ObjectServer &server, const QStringList &hashes,
+									  const QString &target)
+	{
+		auto batch = BatchDownload::make(server.baseUrl());
+		for (auto hash : hashes)
+		{
+			QString objectName = hash.left(2) + "/" + hash;
+			batch->addFile(objectName, target + "/" + objectName, hash,
+						   server.files.value("/" + objectName).size());
+		}
+		return batch;
+	}
+
+	static bool runJob(NetJob &job)
+	{
+		QSignalSpy succeededSpy(&job, SIGNAL(succeeded()));
+		QEventLoop loop;
+		connect(&job, SIGNAL(succeeded()), &loop, SLOT(quit()));
+		connect(&job, SIGNAL(failed()), &loop, SLOT(quit()));
+		QTimer::singleShot(60000, &loop, SLOT(quit()));
+		job.start();
+		loop.exec();
+		return succeededSpy.count() == 1;
+	}
+
+	static bool checkObjects(ObjectServer &server, const QStringList &hashes,
+							 const QString &target)
+	{
+		for (auto hash : hashes)
+		{
+			QString objectName = hash.left(2) + "/" + hash;
+			QFile file(target + "/" + objectName);
+			if (!file.open(QIODevice::ReadOnly))
+				return false;
+			if (file.readAll() != server.files.value("/" + objectName))
+				return false;
+		}
+		return true;
+	}
+
+private
+slots:
+	void test_DownloadsEverything()
+	{
+		ObjectServer server;
+		QVERIFY(server.listen(QHostAddress::LocalHost));
+		QStringList hashes;
+		for (int i = 0; i < 200; i++)
+			hashes.append(server.addObject(100 + i * 13));
+
+		QTemporaryDir target;
+		NetJob job("test");
+		auto batch = makeBatch(server, hashes, target.path());
+		job.addNetAction(batch);
+		QVERIFY(runJob(job));
+		QVERIFY(checkObjects(server, hashes, target.path()));
+		QCOMPARE(server.requests, hashes.size());
+		// connections get reused instead of opening one per object
+		QVERIFY(server.connections <= 6);
+		QCOMPARE(batch->currentProgress(), batch->totalProgress());
+	}
+
+	void test_RejectsBadObjects()
+	{
+		ObjectServer server;
+		QVERIFY(server.listen(QHostAddress::LocalHost));
+		QStringList hashes;
+		for (int i = 0; i < 20; i++)
+			hashes.append(server.addObject(1000));
+		// corrupt one, drop another
+		QString corrupt = hashes[3];
+		QString missing = hashes[7];
+		QByteArray &corruptContent = server.files["/" + corrupt.left(2) + "/" + corrupt];
+		corruptContent[0] = char(corruptContent.at(0) ^ 0x7f);
+		server.files.remove("/" + missing.left(2) + "/" + missing);
+
+		QTemporaryDir target;
+		auto batch = makeBatch(server, hashes, target.path());
+		QSignalSpy failedSpy(batch.get(), SIGNAL(failed(int)));
+		batch->start();
+		QVERIFY(failedSpy.wait(30000));
+		QCOMPARE(batch->failedFiles().size(), 2);
+		QVERIFY(!QFile::exists(target.path() + "/" + corrupt.left(2) + "/" + corrupt));
+		QVERIFY(!QFile::exists(target.path() + "/" + missing.left(2) + "/" + missing));
+
+		// a restart only fetches what failed
+		int requestsBefore = server.requests;
+		batch->start();
+		QVERIFY(failedSpy.wait(30000));
+		QCOMPARE(server.requests - requestsBefore, 2);
+	}
+
+	void benchmark_BatchDownload()
+	{
+		ObjectServer server;
+		QVERIFY(server.listen(QHostAddress::LocalHost));
+		QStringList hashes;
+		for (int i = 0; i < 1000; i++)
+			hashes.append(server.addObject(2000));
+
+		QBENCHMARK
+		{
+			QTemporaryDir target;
+			NetJob job("benchmark");
+			job.addNetAction(makeBatch(server, hashes, target.path()));
+			QVERIFY(runJob(job));
+		}
+	}
+
+	void benchmark_PerObjectDownload()
+	{
+		ObjectServer server;
+		QVERIFY(server.listen(QHostAddress::LocalHost));
+		QStringList hashes;
+		for (int i = 0; i < 1000; i++)
+			hashes.append(server.addObject(2000));
+
+		QBENCHMARK
+		{
+			QTemporaryDir target;
+			NetJob job("benchmark");
+			for (auto hash : hashes)
+			{
+				QString objectName = hash.left(2) + "/" + hash;
+				job.addNetAction(MD5EtagDownload::make(server.baseUrl().resolved(QUrl(objectName)),
+													   target.path() + "/" + objectName));
+			}
+			QVERIFY(runJob(job));
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN_MULTIMC(BatchDownloadTest)
+
+#include "tst_BatchDownload.moc"
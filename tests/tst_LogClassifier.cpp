@@ -0,0 +1,121 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "logic/LogClassifier.h"
+
+Q_DECLARE_METATYPE(MessageLevel::Enum)
+
+class LogClassifierTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_Level_data()
+	{
+		QTest::addColumn<QString>("line");
+		QTest::addColumn<MessageLevel::Enum>("level");
+
+		QTest::newRow("log4j info") << "[12:04:31] [main/INFO]: Loading tweak class"
+									<< MessageLevel::Message;
+		QTest::newRow("log4j warn") << "[12:04:32] [main/WARN] [FML]: no MCVersion annotation"
+									<< MessageLevel::Warning;
+		QTest::newRow("log4j error") << "[12:04:38] [Client thread/ERROR] [FML]: bad signature"
+									 << MessageLevel::Error;
+		QTest::newRow("log4j fatal") << "[12:04:41] [Client thread/FATAL] [FML]: cannot continue"
+									 << MessageLevel::Fatal;
+		QTest::newRow("log4j trace") << "[12:04:40] [Client thread/TRACE] [FML]: injecting"
+									 << MessageLevel::Debug;
+		QTest::newRow("log4j unknown") << "[12:04:40] [Client thread/NOISE]: something"
+									   << MessageLevel::Info;
+		QTest::newRow("log4j not first") << "[STDERR] [12:04:31] [main/WARN]: nested"
+										 << MessageLevel::Warning;
+		QTest::newRow("old info") << "2014-07-12 12:04:31 [INFO] [ForgeModLoader] loading"
+								  << MessageLevel::Message;
+		QTest::newRow("old severe") << "2014-07-12 12:04:32 [SEVERE] [ForgeModLoader] wrong"
+									<< MessageLevel::Error;
+		QTest::newRow("old stderr wins over info") << "2014-07-12 [INFO] [STDERR] trace"
+												   << MessageLevel::Error;
+		QTest::newRow("old debug wins over all") << "[WARNING] [DEBUG] [SEVERE] [INFO]"
+												 << MessageLevel::Debug;
+		QTest::newRow("stack trace") << "\tat net.minecraft.client.Minecraft.startGame"
+									 << MessageLevel::Error;
+		QTest::newRow("not a stack trace") << "at the start of the line" << MessageLevel::Info;
+		QTest::newRow("exception") << "Exception in thread \"main\" java.lang.Error"
+								   << MessageLevel::Error;
+		QTest::newRow("overwriting") << "[12:04:41] [main/INFO]: overwriting existing item"
+									 << MessageLevel::Fatal;
+		QTest::newRow("plain") << "OpenAL initialized." << MessageLevel::Info;
+	}
+	void test_Level()
+	{
+		QFETCH(QString, line);
+		QFETCH(MessageLevel::Enum, level);
+
+		LogClassifier classifier;
+		QString copy = line;
+		QCOMPARE(classifier.classify(copy, MessageLevel::Info), level);
+		QCOMPARE(copy, line);
+	}
+
+	void test_Prefix()
+	{
+		LogClassifier classifier;
+		QString line = "!![Warning]![12:04:41] [main/ERROR]: not guessed";
+		QCOMPARE(classifier.classify(line, MessageLevel::Info), MessageLevel::Warning);
+		QCOMPARE(line, QString("[12:04:41] [main/ERROR]: not guessed"));
+	}
+
+	void test_Censor()
+	{
+		LogClassifier classifier;
+		classifier.addSecret("token:abcd:1234", "<SESSION ID>");
+		classifier.addSecret("abcd", "<ACCESS TOKEN>");
+		classifier.addSecret("1234", "<PROFILE ID>");
+		classifier.addSecret("Steve", "<PROFILE NAME>");
+		classifier.addSecret("", "<NOTHING>");
+
+		QCOMPARE(classifier.censor("--session token:abcd:1234 --uuid 1234 --username Steve"),
+				 QString("--session <SESSION ID> --uuid <PROFILE ID> --username <PROFILE NAME>"));
+		QCOMPARE(classifier.censor("abcabcd12341234"),
+				 QString("abc<ACCESS TOKEN><PROFILE ID><PROFILE ID>"));
+		QCOMPARE(classifier.censor("nothing to see"), QString("nothing to see"));
+
+		QString line = "[12:04:33] [main/WARN]: Setting user: Steve";
+		QCOMPARE(classifier.classify(line, MessageLevel::Info), MessageLevel::Warning);
+		QCOMPARE(line, QString("[12:04:33] [main/WARN]: Setting user: <PROFILE NAME>"));
+
+		line = "Steve";
+		classifier.classify(line, MessageLevel::Info, true, false);
+		QCOMPARE(line, QString("Steve"));
+
+		classifier.clearSecrets();
+		QCOMPARE(classifier.censor("Steve"), QString("Steve"));
+	}
+
+	void benchmark_Classify()
+	{
+		QStringList sample = MULTIMC_GET_TEST_FILE_UTF8("tests/data/forge-startup.log").split('\n');
+		QStringList lines;
+		for (int i = 0; i < 500; i++)
+			lines.append(sample);
+
+		LogClassifier classifier;
+		classifier.addSecret("token:0123456789abcdef0123456789abcdef:fedcba9876543210",
+							 "<SESSION ID>");
+		classifier.addSecret("0123456789abcdef0123456789abcdef", "<ACCESS TOKEN>");
+		classifier.addSecret("b2c3d4e5f60718293a4b5c6d7e8f9012", "<CLIENT TOKEN>");
+		classifier.addSecret("fedcba9876543210", "<PROFILE ID>");
+		classifier.addSecret("Steve", "<PROFILE NAME>");
+		classifier.addSecret("[{\"name\":\"twitch_access_token\"}]", "<TWITCH_ACCESS_TOKEN>");
+
+		QBENCHMARK
+		{
+			for (auto line : lines)
+				classifier.classify(line, MessageLevel::Message);
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN_MULTIMC(LogClassifierTest)
+
+#include "tst_LogClassifier.moc"
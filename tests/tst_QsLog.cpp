@@ -0,0 +1,126 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QtConcurrentRun>
+#include "TestUtil.h"
+
+#include "logger/QsLog.h"
+#include "logger/QsLogDest.h"
+
+/// remembers what it was given, and on which thread
+class RecordingDestination : public QsLogging::Destination
+{
+public:
+	virtual ~RecordingDestination()
+	{
+		QsLogging::Logger::instance().removeDestination(this);
+	}
+	virtual void write(const QString &message)
+	{
+		messages.append(message);
+		threads.insert(QThread::currentThread());
+	}
+	virtual void flush()
+	{
+		flushes++;
+	}
+
+	QStringList messages;
+	QSet<QThread *> threads;
+	int flushes = 0;
+};
+
+class QsLogTest : public QObject
+{
+	Q_OBJECT
+private:
+	/// the number following the word in a message
+	static int numberAfter(const QString &message, const QString &word)
+	{
+		int start = message.indexOf(word + " ") + word.size() + 1;
+		return message.mid(start).section(' ', 0, 0).toInt();
+	}
+
+	static void logLines(int thread, int count)
+	{
+		for (int i = 0; i < count; i++)
+			QLOG_INFO() << "thread" << thread << "line" << i;
+	}
+
+private
+slots:
+	void test_KeepsOrder()
+	{
+		RecordingDestination destination;
+		QsLogging::Logger::instance().addDestination(&destination);
+		for (int i = 0; i < 1000; i++)
+			QLOG_INFO() << "line" << i;
+		QsLogging::Logger::instance().flush();
+
+		QCOMPARE(destination.messages.size(), 1000);
+		for (int i = 0; i < 1000; i++)
+			QCOMPARE(numberAfter(destination.messages[i], "line"), i);
+		// written in the background, in batches
+		QVERIFY(!destination.threads.contains(QThread::currentThread()));
+		QVERIFY(destination.flushes < 1000);
+	}
+
+	void test_ManyThreads()
+	{
+		RecordingDestination destination;
+		QsLogging::Logger::instance().addDestination(&destination);
+		QList<QFuture<void>> producers;
+		for (int thread = 0; thread < 4; thread++)
+			producers.append(QtConcurrent::run(&QsLogTest::logLines, thread, 5000));
+		for (auto &producer : producers)
+			producer.waitForFinished();
+		QsLogging::Logger::instance().flush();
+
+		QCOMPARE(destination.messages.size(), 20000);
+		// each thread's lines stay in order
+		int next[4] = {0, 0, 0, 0};
+		for (auto &message : destination.messages)
+		{
+			int thread = numberAfter(message, "thread");
+			int line = numberAfter(message, "line");
+			QCOMPARE(line, next[thread]);
+			next[thread]++;
+		}
+	}
+
+	void test_FatalIsWrittenRightAway()
+	{
+		RecordingDestination destination;
+		QsLogging::Logger::instance().addDestination(&destination);
+		QLOG_INFO() << "before";
+		QLOG_FATAL() << "the end";
+		QCOMPARE(destination.messages.size(), 2);
+		QVERIFY(destination.messages[1].contains("the end"));
+	}
+
+	void benchmark_FileThroughput()
+	{
+		QTemporaryDir dir;
+		auto destination =
+			QsLogging::DestinationFactory::MakeFileDestination(dir.path() + "/benchmark.log");
+		QsLogging::Logger::instance().addDestination(destination.get());
+
+		const int lines = 100000;
+		QElapsedTimer timer;
+		qint64 elapsed = 0;
+		int runs = 0;
+		QBENCHMARK
+		{
+			timer.start();
+			logLines(0, lines);
+			QsLogging::Logger::instance().flush();
+			elapsed += timer.nsecsElapsed();
+			runs++;
+		}
+		qDebug() << "lines per second:" << qint64(lines * runs * 1e9 / qMax(elapsed, qint64(1)));
+	}
+};
+
+QTEST_GUILESS_MAIN_MULTIMC(QsLogTest)
+
+#include "tst_QsLog.moc"
@@ -0,0 +1,254 @@
+#include <QTest>
+#include <QTemporaryDir>
+
+#include "TestUtil.h"
+
+#include <quazip.h>
+#include <quazipfile.h>
+#include <JlCompress.h>
+
+class QuaZipTest : public QObject
+{
+	Q_OBJECT
+private:
+	QTemporaryDir m_dir;
+	QString m_jar;
+	QHash<QString, QByteArray> m_contents;
+	QString m_tree;
+
+	/// something that compresses about as well as class files do
+	static QByteArray makeContent(int size)
+	{
+		static const char *words[] = {"java/lang/Object", "<init>", "Code", "LineNumberTable",
+									  "net/minecraft/", "(Ljava/lang/String;)V", "I", "Z"};
+		QByteArray content;
+		content.reserve(size + 32);
+		while (content.size() < size)
+		{
+			content.append(words[qrand() % 8]);
+			content.append(char(qrand()));
+		}
+		content.truncate(size);
+		return content;
+	}
+
+	static QHash<QString, QByteArray> readAll(const QString &path, bool mapped)
+	{
+		QHash<QString, QByteArray> result;
+		QuaZip zip(path);
+		zip.setMemoryMappingEnabled(mapped);
+		if (!zip.open(QuaZip::mdUnzip))
+			return result;
+		for (bool more = zip.goToFirstFile(); more; more = zip.goToNextFile())
+		{
+			QuaZipFile file(&zip);
+			if (!file.open(QIODevice::ReadOnly))
+				return QHash<QString, QByteArray>();
+			result.insert(file.getActualFileName(), file.readAll());
+			file.close();
+		}
+		return result;
+	}
+
+	static bool copyAll(const QString &from, const QString &into, bool mapped)
+	{
+		QuaZip zipIn(from);
+		zipIn.setMemoryMappingEnabled(mapped);
+		QuaZip zipOut(into);
+		if (!zipIn.open(QuaZip::mdUnzip) || !zipOut.open(QuaZip::mdCreate))
+			return false;
+		for (bool more = zipIn.goToFirstFile(); more; more = zipIn.goToNextFile())
+		{
+			if (!JlCompress::copyRawFile(&zipIn, &zipOut))
+				return false;
+		}
+		zipOut.close();
+		return zipOut.getZipError() == ZIP_OK;
+	}
+
+	static QList<QuaZipFileInfo> entries(const QString &path)
+	{
+		QuaZip zip(path);
+		zip.open(QuaZip::mdUnzip);
+		return zip.getFileInfoList();
+	}
+
+	/// compress the way compressFile() did before it was parallel, through QuaZipFile
+	static bool compressSerially(const QString &path, const QString &dir,
+								 const QStringList &names)
+	{
+		QuaZip zip(path);
+		if (!zip.open(QuaZip::mdCreate))
+			return false;
+		for (auto name : names)
+		{
+			QFile inFile(dir + "/" + name);
+			QuaZipFile outFile(&zip);
+			if (!inFile.open(QIODevice::ReadOnly) ||
+				!outFile.open(QIODevice::WriteOnly, QuaZipNewInfo(name, inFile.fileName())))
+				return false;
+			outFile.write(inFile.readAll());
+			outFile.close();
+		}
+		zip.close();
+		return zip.getZipError() == ZIP_OK;
+	}
+
+private
+slots:
+	void initTestCase()
+	{
+		QVERIFY(m_dir.isValid());
+		// an unpacked jar, with an empty file and a few that are split into chunks
+		m_tree = m_dir.path() + "/tree";
+		QVERIFY(QDir().mkpath(m_tree + "/net/minecraft"));
+		for (int i = 0; i < 300; i++)
+		{
+			int size = i == 0 ? 0 : i % 50 ? 100 + i * 97 : 3 * 1024 * 1024 + i;
+			QFile file(m_tree + QString("/net/minecraft/file%1.class").arg(i));
+			QVERIFY(file.open(QIODevice::WriteOnly));
+			file.write(makeContent(size));
+		}
+
+		m_jar = m_dir.path() + "/client.jar";
+		QuaZip zip(m_jar);
+		QVERIFY(zip.open(QuaZip::mdCreate));
+		for (int i = 0; i < 2000; i++)
+		{
+			QString name = QString("net/minecraft/class%1.class").arg(i);
+			QByteArray content = makeContent(500 + (i * 37) % 20000);
+			m_contents.insert(name, content);
+			QuaZipFile file(&zip);
+			// every tenth file is stored, like the signature files and images in real jars
+			QVERIFY(file.open(QIODevice::WriteOnly, QuaZipNewInfo(name), NULL, 0,
+							  i % 10 ? Z_DEFLATED : 0));
+			QCOMPARE(file.write(content), qint64(content.size()));
+			file.close();
+		}
+		zip.close();
+		QCOMPARE(zip.getZipError(), ZIP_OK);
+	}
+
+	void test_ReadMapped()
+	{
+		QVERIFY(readAll(m_jar, true) == m_contents);
+	}
+
+	void test_ReadUnmapped()
+	{
+		QVERIFY(readAll(m_jar, false) == m_contents);
+	}
+
+	void test_CopyMapped()
+	{
+		QString copy = m_dir.path() + "/copy.jar";
+		QVERIFY(copyAll(m_jar, copy, true));
+		QVERIFY(readAll(copy, false) == m_contents);
+	}
+
+	void test_EmptyFileFallsBack()
+	{
+		// can't be mapped, has to fail like before instead of crashing
+		QString empty = m_dir.path() + "/empty.jar";
+		QFile file(empty);
+		QVERIFY(file.open(QIODevice::WriteOnly));
+		file.close();
+		QuaZip zip(empty);
+		QVERIFY(!zip.open(QuaZip::mdUnzip));
+	}
+
+	void test_CompressDir()
+	{
+		QString jar = m_dir.path() + "/compressed.jar";
+		QVERIFY(JlCompress::compressDir(jar, m_tree));
+		auto parallel = entries(jar);
+		QCOMPARE(parallel.size(), 300);
+
+		QStringList names;
+		for (auto entry : parallel)
+			names.append(entry.name);
+		QString reference = m_dir.path() + "/reference.jar";
+		QVERIFY(compressSerially(reference, m_tree, names));
+		auto serial = entries(reference);
+		QCOMPARE(serial.size(), parallel.size());
+		for (int i = 0; i < serial.size(); i++)
+		{
+			QCOMPARE(parallel[i].name, serial[i].name);
+			QCOMPARE(parallel[i].versionNeeded, serial[i].versionNeeded);
+			QCOMPARE(parallel[i].flags, serial[i].flags);
+			QCOMPARE(parallel[i].method, serial[i].method);
+			QCOMPARE(parallel[i].dateTime, serial[i].dateTime);
+			QCOMPARE(parallel[i].crc, serial[i].crc);
+			QCOMPARE(parallel[i].uncompressedSize, serial[i].uncompressedSize);
+			QCOMPARE(parallel[i].externalAttr, serial[i].externalAttr);
+		}
+		QVERIFY(readAll(jar, true) == readAll(reference, true));
+	}
+
+	void test_CompressMissingFile()
+	{
+		QuaZip zip(m_dir.path() + "/missing.jar");
+		QVERIFY(zip.open(QuaZip::mdCreate));
+		QVERIFY(!JlCompress::compressFiles(&zip, QStringList() << m_dir.path() + "/nothing",
+										   QStringList() << "nothing"));
+	}
+
+	void benchmark_ReadMapped()
+	{
+		QBENCHMARK
+		{
+			QVERIFY(!readAll(m_jar, true).isEmpty());
+		}
+	}
+
+	void benchmark_ReadUnmapped()
+	{
+		QBENCHMARK
+		{
+			QVERIFY(!readAll(m_jar, false).isEmpty());
+		}
+	}
+
+	void benchmark_CopyMapped()
+	{
+		QString copy = m_dir.path() + "/copy.jar";
+		QBENCHMARK
+		{
+			QVERIFY(copyAll(m_jar, copy, true));
+		}
+	}
+
+	void benchmark_CompressDir()
+	{
+		QString jar = m_dir.path() + "/compressed.jar";
+		QBENCHMARK
+		{
+			QVERIFY(JlCompress::compressDir(jar, m_tree));
+		}
+	}
+
+	void benchmark_CompressSerially()
+	{
+		QString jar = m_dir.path() + "/reference.jar";
+		QStringList names;
+		for (auto entry : entries(m_dir.path() + "/compressed.jar"))
+			names.append(entry.name);
+		QBENCHMARK
+		{
+			QVERIFY(compressSerially(jar, m_tree, names));
+		}
+	}
+
+	void benchmark_CopyUnmapped()
+	{
+		QString copy = m_dir.path() + "/copy.jar";
+		QBENCHMARK
+		{
+			QVERIFY(copyAll(m_jar, copy, false));
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN_MULTIMC(QuaZipTest)
+
+#include "tst_QuaZip.moc"
@@ -36,6 +36,61 @@ slots:
 		
 		QCOMPARE(back, through);
 	}
+
+	void test_LoadFile()
+	{
+		QByteArray content = "\xEF\xBB\xBF"
+							 "name=Some instance\r\n"
+							 "  iconKey =  flame  \n"
+							 "# a comment=with an equals sign\n"
+							 "notes=first\\nsecond\\tthird\\\\ # and a comment\n"
+							 "not a setting\n"
+							 "empty=\n"
+							 "unicode=\xC5\xBElu\xC5\xA5ou\xC4\x8Dk\xC3\xBD k\xC5\xAF\xC5\x88\n"
+							 "last=no newline";
+		INIFile ini;
+		QVERIFY(ini.loadFile(content));
+		QCOMPARE(ini.size(), 6);
+		QCOMPARE(ini.get("name", QVariant()).toString(), QString("Some instance"));
+		QCOMPARE(ini.get("iconKey", QVariant()).toString(), QString("flame"));
+		QCOMPARE(ini.get("notes", QVariant()).toString(), QString("first\nsecond\tthird\\"));
+		QCOMPARE(ini.get("empty", QVariant()).toString(), QString());
+		QCOMPARE(ini.get("unicode", QVariant()).toString(),
+				 QString::fromUtf8("\xC5\xBElu\xC5\xA5ou\xC4\x8Dk\xC3\xBD k\xC5\xAF\xC5\x88"));
+		QCOMPARE(ini.get("last", QVariant()).toString(), QString("no newline"));
+	}
+
+	void benchmark_LoadFile()
+	{
+		// configs shaped like the instance.cfg files
+		QList<QByteArray> configs;
+		for (int i = 0; i < 5000; i++)
+		{
+			QByteArray config;
+			config += "InstanceType=OneSix\n";
+			config += "name=Instance number " + QByteArray::number(i) + "\n";
+			config += "iconKey=infinity\n";
+			config += "IntendedVersion=1.7.10\n";
+			config += "lastLaunchTime=" + QByteArray::number(1400000000000LL + i) + "\n";
+			config += "notes=Some notes\\nover a few lines\\n\\tindented\n";
+			config += "OverrideMemory=true\n";
+			config += "MinMemAlloc=512\n";
+			config += "MaxMemAlloc=" + QByteArray::number(1024 + i % 4 * 512) + "\n";
+			config += "JvmArgs=-XX:+UseConcMarkSweepGC -XX:+CMSIncrementalMode\n";
+			config += "LaunchMaximized=false\n";
+			config += "MinecraftWinWidth=854\n";
+			config += "MinecraftWinHeight=480\n";
+			configs.append(config);
+		}
+		QBENCHMARK
+		{
+			for (auto &config : configs)
+			{
+				INIFile ini;
+				ini.loadFile(config);
+			}
+		}
+	}
 };
 
 QTEST_GUILESS_MAIN_MULTIMC(IniFileTest)